@@ -0,0 +1,48 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+// Writes checkpoints of a long computation on a background thread. The computation
+// submits a snapshot as a closure that serializes it (capturing immutable or shared
+// state, so submitting costs a few pointer copies) and carries on. The file is written
+// to `path.tmp` and renamed over `path`, so a crash never leaves a torn checkpoint.
+// A snapshot submitted while another is being written replaces any older pending one.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(std::string path);
+
+    // Finishes the pending write, errors are dropped here (call flush() to see them)
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void submit(std::function<void(std::ostream &)> snapshot);
+
+    // Waits until the last submitted snapshot is on disk, rethrows a failed write
+    void flush();
+
+    const std::string &path() const { return file_path; }
+
+private:
+    void loop();
+
+    std::string file_path;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::function<void(std::ostream &)> pending;
+    bool busy = false;
+    bool stopping = false;
+    std::exception_ptr error;
+    std::thread worker;
+};
+
+#endif // CHECKPOINT_H
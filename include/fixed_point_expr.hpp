@@ -0,0 +1,215 @@
+#ifndef FIXED_POINT_EXPR_H
+#define FIXED_POINT_EXPR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <type_traits>
+
+#include "long_arithmetic.hpp"
+
+// Lazy arithmetic over FixedPoint. lazy(x) starts an expression; + and - with other
+// expressions or FixedPoints and * and / by machine words extend it, and converting it
+// to FixedPoint evaluates the whole chain with FixedPoint::linear_combination: one
+// accumulator instead of a temporary per operator, with the same result as the eager
+// operators. Operations the accumulator cannot fuse (a product of two numbers, a word
+// division of a sum) evaluate their operand first. Operands are referenced, so an
+// expression has to be evaluated within the full expression that builds it:
+//   res += (lazy(four) / (8u * i + 1) - lazy(two) / (8u * i + 4)) / base;
+namespace fixed_point_expr {
+
+// Terms collected from an expression tree, with the values evaluated on the way
+template <size_t N>
+struct Terms {
+    std::array<FixedPoint::Term, N> list;
+    size_t count = 0;
+    std::forward_list<FixedPoint> temporaries;
+
+    void add(const FixedPoint &value, uint32_t mul, uint32_t div, bool negative) {
+        list[count++] = {&value, mul, div, negative};
+    }
+
+    const FixedPoint &keep(FixedPoint &&value) {
+        temporaries.push_front(std::move(value));
+        return temporaries.front();
+    }
+};
+
+// Base of all expression nodes. E::terms bounds the terms the node contributes and
+// E::collect(terms, mul, negative) appends them, scaled by mul and negated if asked.
+template <class E>
+struct Expr {
+    const E &self() const { return static_cast<const E &>(*this); }
+
+    FixedPoint eval() const {
+        Terms<E::terms> terms;
+        self().collect(terms, 1, false);
+        return FixedPoint::linear_combination(terms.list.data(), terms.count);
+    }
+
+    operator FixedPoint() const { return eval(); }
+};
+
+// A FixedPoint operand
+struct Ref : Expr<Ref> {
+    static constexpr size_t terms = 1;
+
+    explicit Ref(const FixedPoint &value) : value(value) {}
+
+    template <size_t N>
+    void collect(Terms<N> &t, uint32_t mul, bool negative) const {
+        t.add(value, mul, 1, negative);
+    }
+
+    const FixedPoint &value;
+};
+
+// left + right, or left - right
+template <class L, class R, bool Subtract>
+struct Sum : Expr<Sum<L, R, Subtract>> {
+    static constexpr size_t terms = L::terms + R::terms;
+
+    Sum(const L &left, const R &right) : left(left), right(right) {}
+
+    template <size_t N>
+    void collect(Terms<N> &t, uint32_t mul, bool negative) const {
+        left.collect(t, mul, negative);
+        right.collect(t, mul, negative != Subtract);
+    }
+
+    L left;
+    R right;
+};
+
+// operand * factor, distributed over the terms of the operand since it is exact
+template <class E>
+struct Product : Expr<Product<E>> {
+    static constexpr size_t terms = E::terms;
+
+    Product(const E &operand, uint32_t factor) : operand(operand), factor(factor) {}
+
+    template <size_t N>
+    void collect(Terms<N> &t, uint32_t mul, bool negative) const {
+        uint64_t combined = static_cast<uint64_t>(mul) * factor;
+        if (combined >> 32) {
+            // The factors no longer fit into a word together
+            t.add(t.keep(operand.eval() * factor), mul, 1, negative);
+        } else {
+            operand.collect(t, static_cast<uint32_t>(combined), negative);
+        }
+    }
+
+    E operand;
+    uint32_t factor;
+};
+
+// operand / divisor, truncated at the precision of the operand. Only a plain operand
+// becomes a divided term, anything else is evaluated first as the eager operators do.
+template <class E>
+struct Quotient : Expr<Quotient<E>> {
+    static constexpr size_t terms = 1;
+
+    Quotient(const E &operand, uint32_t divisor) : operand(operand), divisor(divisor) {}
+
+    template <size_t N>
+    void collect(Terms<N> &t, uint32_t mul, bool negative) const {
+        if constexpr (std::is_same_v<E, Ref>) {
+            t.add(operand.value, mul, divisor, negative);
+        } else {
+            t.add(t.keep(operand.eval()), mul, divisor, negative);
+        }
+    }
+
+    E operand;
+    uint32_t divisor;
+};
+
+template <class L, class R>
+Sum<L, R, false> operator+(const Expr<L> &left, const Expr<R> &right) {
+    return {left.self(), right.self()};
+}
+
+template <class L>
+Sum<L, Ref, false> operator+(const Expr<L> &left, const FixedPoint &right) {
+    return {left.self(), Ref(right)};
+}
+
+template <class R>
+Sum<Ref, R, false> operator+(const FixedPoint &left, const Expr<R> &right) {
+    return {Ref(left), right.self()};
+}
+
+template <class L, class R>
+Sum<L, R, true> operator-(const Expr<L> &left, const Expr<R> &right) {
+    return {left.self(), right.self()};
+}
+
+template <class L>
+Sum<L, Ref, true> operator-(const Expr<L> &left, const FixedPoint &right) {
+    return {left.self(), Ref(right)};
+}
+
+template <class R>
+Sum<Ref, R, true> operator-(const FixedPoint &left, const Expr<R> &right) {
+    return {Ref(left), right.self()};
+}
+
+// Only machine words are fused, other numbers convert to FixedPoint below
+template <class E, typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+Product<E> operator*(const Expr<E> &operand, T factor) {
+    return {operand.self(), factor};
+}
+
+template <class E, typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+Product<E> operator*(T factor, const Expr<E> &operand) {
+    return {operand.self(), factor};
+}
+
+template <class E, typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+Quotient<E> operator/(const Expr<E> &operand, T divisor) {
+    return {operand.self(), divisor};
+}
+
+// Operations between two full numbers evaluate the expression and use the eager operator
+template <class E>
+FixedPoint operator*(const Expr<E> &left, const FixedPoint &right) {
+    return left.eval() * right;
+}
+
+template <class E>
+FixedPoint operator*(const FixedPoint &left, const Expr<E> &right) {
+    return left * right.eval();
+}
+
+template <class E>
+FixedPoint operator/(const Expr<E> &left, const FixedPoint &right) {
+    return left.eval() / right;
+}
+
+template <class E>
+FixedPoint operator/(const FixedPoint &left, const Expr<E> &right) {
+    return left / right.eval();
+}
+
+// x += expression folds x into the same accumulator
+template <class E>
+FixedPoint &operator+=(FixedPoint &left, const Expr<E> &right) {
+    left = (Ref(left) + right).eval();
+    return left;
+}
+
+template <class E>
+FixedPoint &operator-=(FixedPoint &left, const Expr<E> &right) {
+    left = (Ref(left) - right).eval();
+    return left;
+}
+
+} // namespace fixed_point_expr
+
+// Starts a lazily evaluated expression over value
+inline fixed_point_expr::Ref lazy(const FixedPoint &value) {
+    return fixed_point_expr::Ref(value);
+}
+
+#endif // FIXED_POINT_EXPR_H
@@ -0,0 +1,62 @@
+#ifndef LIMB_POOL_H
+#define LIMB_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "limb_vector.hpp"
+
+// Arena of limb buffers for one computation phase, e.g. a series evaluation that
+// creates and drops millions of temporaries of recurring sizes. Buffers are rounded
+// up to power-of-two size classes and carved from large chunks; a freed buffer goes
+// to a free list of its class and serves the next request of that class. Every thread
+// allocates from a cache of its own without locking; buffers freed on another thread
+// are handed back to their cache through a lock-free list. Buffers above MAX_CLASS
+// limbs bypass the pool.
+//
+// The memory goes back to the system only at once, in reset() or the destructor, so
+// the pool must outlive every buffer taken from it.
+class LimbPool : public LimbAllocator {
+public:
+    static constexpr size_t MIN_CLASS = 8;
+    static constexpr size_t MAX_CLASS = size_t(1) << 16;
+
+    LimbPool();
+    ~LimbPool() override;
+
+    LimbPool(const LimbPool&) = delete;
+    LimbPool& operator=(const LimbPool&) = delete;
+
+    uint32_t *allocate(size_t &n) override;
+    void deallocate(uint32_t *p, size_t n) override;
+
+    // Releases all chunks in bulk. No buffer of the pool may still be in use and no
+    // other thread may be allocating from it.
+    void reset();
+
+    // Bytes held in chunks, used or free
+    size_t reserved() const;
+
+private:
+    struct Block;
+    struct Cache;
+
+    // The cache of the calling thread, created on its first allocation
+    Cache &local_cache();
+
+    // Link to the next block of a free list, kept in the first limbs of a free block
+    static Block *&next(Block *block);
+
+    // Carves a block of the size class from the chunks of cache
+    Block *carve(Cache &cache, size_t size_class);
+
+    const uint64_t id;
+    mutable std::mutex lock;
+    std::vector<std::unique_ptr<Cache>> caches;
+    std::vector<void *> chunks;
+};
+
+#endif // LIMB_POOL_H
@@ -0,0 +1,119 @@
+#ifndef LIMB_VECTOR_H
+#define LIMB_VECTOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Source of the heap buffers of LimbVector. The default is the global heap; an
+// allocator installed with ScopedLimbAllocator serves the buffers created on that
+// thread while the scope lasts. Every buffer remembers its allocator, so it can be
+// freed anywhere, also on another thread or after the scope has ended.
+class LimbAllocator {
+public:
+    virtual ~LimbAllocator() = default;
+
+    // Returns a buffer for at least n limbs and sets n to the limbs it really holds
+    virtual uint32_t *allocate(size_t &n) = 0;
+
+    // Takes back a buffer of n limbs returned by allocate(), on any thread
+    virtual void deallocate(uint32_t *p, size_t n) = 0;
+
+    // Allocator for new buffers on the calling thread, nullptr for the global heap
+    static LimbAllocator *current();
+};
+
+// Makes allocator (nullptr: the global heap) the current one of this thread until the
+// end of the scope. Scopes nest.
+class ScopedLimbAllocator {
+public:
+    explicit ScopedLimbAllocator(LimbAllocator *allocator);
+    ~ScopedLimbAllocator();
+
+    ScopedLimbAllocator(const ScopedLimbAllocator&) = delete;
+    ScopedLimbAllocator& operator=(const ScopedLimbAllocator&) = delete;
+
+private:
+    LimbAllocator *saved;
+};
+
+// Growable array of limbs with the interface FixedPoint needs from std::vector. Up to
+// INLINE_LIMBS limbs live inside the object, so creating, copying and moving short
+// numbers never touches the heap; longer arrays spill to a heap buffer that grows
+// geometrically like a vector, taken from LimbAllocator::current(). Iterators are
+// plain pointers.
+class LimbVector {
+public:
+    static constexpr size_t INLINE_LIMBS = 8;
+
+    using value_type = uint32_t;
+    using iterator = uint32_t *;
+    using const_iterator = const uint32_t *;
+
+    LimbVector() noexcept {}
+    explicit LimbVector(size_t n, uint32_t value = 0);
+    LimbVector(const uint32_t *first, const uint32_t *last);
+
+    LimbVector(const LimbVector &other);
+    LimbVector(LimbVector &&other) noexcept;
+    LimbVector &operator=(const LimbVector &other);
+    LimbVector &operator=(LimbVector &&other) noexcept;
+    ~LimbVector();
+
+    size_t size() const { return sz; }
+    size_t capacity() const { return cap; }
+    bool empty() const { return sz == 0; }
+
+    // Whether the limbs are stored inside the object
+    bool is_inline() const { return cap == INLINE_LIMBS; }
+
+    uint32_t *data() { return is_inline() ? local : heap; }
+    const uint32_t *data() const { return is_inline() ? local : heap; }
+
+    uint32_t &operator[](size_t i) { return data()[i]; }
+    uint32_t operator[](size_t i) const { return data()[i]; }
+    uint32_t &back() { return data()[sz - 1]; }
+    uint32_t back() const { return data()[sz - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + sz; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + sz; }
+
+    void reserve(size_t n) {
+        if (n > cap) grow(n);
+    }
+
+    void push_back(uint32_t value) {
+        if (sz == cap) grow(2 * cap);
+        data()[sz++] = value;
+    }
+
+    void pop_back() { sz--; }
+    void clear() { sz = 0; }
+
+    void resize(size_t n, uint32_t value = 0);
+    void assign(size_t n, uint32_t value);
+    void assign(const uint32_t *first, const uint32_t *last);
+
+    // Inserts n copies of value before pos, returns the first inserted limb
+    iterator insert(const_iterator pos, size_t n, uint32_t value);
+
+    // Removes [first, last), returns the limb that followed them
+    iterator erase(const_iterator first, const_iterator last);
+
+private:
+    // Moves the limbs to a heap buffer of at least new_cap >= size() limbs
+    void grow(size_t new_cap);
+
+    // Returns the heap buffer to the allocator it came from
+    void release();
+
+    size_t sz = 0;
+    size_t cap = INLINE_LIMBS;
+    union {
+        uint32_t local[INLINE_LIMBS];
+        uint32_t *heap;
+    };
+};
+
+#endif // LIMB_VECTOR_H
@@ -0,0 +1,191 @@
+#ifndef LIMBS_H
+#define LIMBS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Low-level kernels over little-endian limb arrays (least significant limb first).
+// They know nothing about signs or the radix point: FixedPoint lays its fractional
+// and integer parts out as one magnitude and hands it to these functions.
+namespace limbs {
+
+using limb_t = uint32_t;   // One digit of the magnitude
+using dlimb_t = uint64_t;  // Wide enough for limb_t * limb_t + 2 * limb_t
+constexpr unsigned LIMB_BITS = 32;
+
+// Crossover points between the multiplication tiers. Sizes are magnitude lengths in
+// limbs (integer + fractional limbs of a FixedPoint) of the shorter operand.
+struct MulThresholds {
+    size_t karatsuba = 64;      // Below this schoolbook multiplication is used
+    size_t sqr_karatsuba = 128; // The same for squaring, whose basecase does half the products
+    size_t toom3 = 256;         // From here on Toom-3 replaces Karatsuba
+    size_t ntt = 2048;          // From here on the number-theoretic transform takes over
+};
+
+// Process-wide thresholds, may be tuned per machine before doing any arithmetic
+MulThresholds &mul_thresholds();
+
+// Length in limbs from which add_n/sub_n switch to the AVX2 carry-lookahead kernels
+// (when the CPU has them). Shorter runs go through the add-with-carry instruction.
+struct AddThresholds {
+    size_t simd = 16;
+};
+
+// Process-wide thresholds, may be tuned per machine before doing any arithmetic
+AddThresholds &add_thresholds();
+
+// r[0 .. n) = a + b + carry, returns the carry out. r may alias a or b
+limb_t add_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t carry = 0);
+
+// r[0 .. n) = a - b - borrow, returns the borrow out. r may alias a or b
+limb_t sub_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t borrow = 0);
+
+// r[0 .. an) = a[0 .. an) + b[0 .. bn) + carry with an >= bn, returns the carry out
+limb_t add(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, limb_t carry = 0);
+
+// r[0 .. an) = a[0 .. an) - b[0 .. bn) - borrow with an >= bn, returns the borrow out
+limb_t sub(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, limb_t borrow = 0);
+
+// r[0 .. n) = B^n - a mod B^n, returns the borrow out (0 only for a == 0). r may alias a
+limb_t neg_n(limb_t *r, const limb_t *a, size_t n);
+
+// Compares a[0 .. an) with b[0 .. bn), leading zero limbs are allowed. Returns -1, 0 or 1
+int cmp(const limb_t *a, size_t an, const limb_t *b, size_t bn);
+
+// Length of a[0 .. n) without its leading (most significant) zero limbs
+size_t normalized_size(const limb_t *a, size_t n);
+
+// r[0 .. n) = a[0 .. n) << shift with 0 <= shift < LIMB_BITS, returns the bits shifted
+// out of the top limb. r may alias a or lie below it
+limb_t lshift(limb_t *r, const limb_t *a, size_t n, unsigned shift);
+
+// r[0 .. n) = a[0 .. n) >> shift with 0 <= shift < LIMB_BITS, the bits shifted out of
+// the bottom are dropped. r may alias a or lie below it
+void rshift(limb_t *r, const limb_t *a, size_t n, unsigned shift);
+
+// r[0 .. n) = a[0 .. n) * b + carry, returns the limb carried out. r may alias a
+limb_t mul_1(limb_t *r, const limb_t *a, size_t n, limb_t b, limb_t carry = 0);
+
+// q[0 .. n) = (rem * B^n + a[0 .. n)) / d, returns the new remainder. rem is what is left
+// over from more significant limbs and must be below d. q may alias a, d must not be zero
+limb_t divmod_1(limb_t *q, const limb_t *a, size_t n, limb_t d, limb_t rem = 0);
+
+// a[0 .. n) % d without computing the quotient, d must not be zero
+limb_t mod_1(const limb_t *a, size_t n, limb_t d);
+
+// Schoolbook multiplication: r[0 .. an + bn) = a[0 .. an) * b[0 .. bn) through the
+// kernel selected below. r must not overlap the operands. Zero limbs of a are skipped.
+void mul_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+
+// Schoolbook squaring r[0 .. 2n) = a[0 .. n)^2 through the same kernel: every product
+// a[i] * a[j] with i < j once, doubled, plus the squares on the diagonal. r must not
+// overlap a.
+void sqr_basecase(limb_t *r, const limb_t *a, size_t n);
+
+// Implementations of mul_basecase, all of them give the same product
+enum class MulKernel {
+    portable, // 32 x 32-bit products, runs everywhere
+    wide,     // Pairs of limbs as 64-bit words with unsigned __int128 products
+    mulx_adx, // 64-bit words, MULX with two carry chains through ADCX and ADOX (BMI2 + ADX)
+    ifma,     // 52-bit digits, eight columns at a time with AVX-512 IFMA
+};
+
+// Whether this CPU can run the kernel. The word kernels need a little-endian host
+bool mul_kernel_supported(MulKernel kernel);
+
+// Name of the kernel as accepted by the FIXED_POINT_MUL_KERNEL environment variable
+const char *mul_kernel_name(MulKernel kernel);
+
+// The kernel mul_basecase uses. It starts as the one FIXED_POINT_MUL_KERNEL names
+// ("portable", "wide", "mulx_adx" or "ifma") if the CPU supports it, and otherwise
+// as the fastest supported one
+MulKernel mul_kernel();
+
+// Pins mul_basecase to a kernel, e.g. for benchmarks. Throws std::runtime_error when
+// the CPU cannot run it. Like the thresholds, set it before doing any arithmetic
+void set_mul_kernel(MulKernel kernel);
+
+// Karatsuba multiplication, requires an >= bn and 2 * bn > an + 1
+void mul_karatsuba(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+
+// Toom-Cook-3 multiplication, requires an >= bn, 2 * bn > an and bn >= 3
+void mul_toom3(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+
+// Squaring counterparts of the two above, require n >= 2 and n >= 3
+void sqr_karatsuba(limb_t *r, const limb_t *a, size_t n);
+void sqr_toom3(limb_t *r, const limb_t *a, size_t n);
+
+// Exact multiplication through a three-prime number-theoretic transform with CRT
+// reconstruction. Any operand lengths, r must not overlap the operands.
+void mul_ntt(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+
+// r[0 .. an + bn) = a * b, picks the tier from mul_thresholds(). Operands of very
+// different lengths are cut into slices of the shorter one instead of being padded.
+// r must not overlap the operands. The same operand twice goes to sqr().
+void mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn);
+
+// r[0 .. 2n) = a[0 .. n)^2 with the tiers of mul() in their squaring forms: half the
+// products in the basecase, one operand to split and evaluate in Karatsuba and Toom-3,
+// one forward transform in the NTT. r must not overlap a.
+void sqr(limb_t *r, const limb_t *a, size_t n);
+
+// Crossover points between the division algorithms, in limbs of the divisor
+struct DivThresholds {
+    size_t newton = 640; // Below this Knuth's long division is used, from here on a Newton reciprocal
+};
+
+// Process-wide thresholds, may be tuned per machine before doing any arithmetic
+DivThresholds &div_thresholds();
+
+// Schoolbook long division (Knuth's Algorithm D): q[0 .. an - n + 1) = a / d and, if r
+// is not null, r[0 .. n) = a % d, where n is the normalized length of d. Nothing is
+// written to q when an < n. Throws std::runtime_error for a zero divisor.
+void divmod_basecase(limb_t *q, limb_t *r, const limb_t *a, size_t an, const limb_t *d, size_t dn);
+
+// Newton reciprocal of a divisor. Computing it costs a few multiplications, after that
+// every division by the same divisor costs about two multiplications per divisor length
+// of quotient. Throws std::runtime_error for a zero divisor.
+struct Reciprocal {
+    std::vector<limb_t> divisor; // Divisor shifted left until its top bit is set
+    unsigned shift;              // The shift applied to the divisor
+    std::vector<limb_t> inverse; // B^n + ..., with divisor * inverse < B^2n <= divisor * (inverse + 2)
+
+    Reciprocal(const limb_t *d, size_t dn);
+};
+
+// q[0 .. an - n + 1) = a / d and, if r is not null, r[0 .. n) = a % d, where n is the
+// normalized length of the divisor behind inv. Nothing is written to q when an < n.
+void divmod(limb_t *q, limb_t *r, const limb_t *a, size_t an, const Reciprocal &inv);
+
+// Length in limbs from which decimal conversion splits the number by powers of 10^9
+// instead of peeling off one 9-digit chunk per pass
+struct RadixThresholds {
+    size_t divide_conquer = 40;
+};
+
+// Process-wide thresholds, may be tuned per machine before doing any arithmetic
+RadixThresholds &radix_thresholds();
+
+// base^exp, normalized (no high zero limbs)
+std::vector<limb_t> pow_1(limb_t base, size_t exp);
+
+// Decimal digits of a[0 .. n), most significant first. Left-padded with zeros to width
+// digits; without padding zero prints as "0". Subquadratic: divides by a tree of
+// powers 10^(9 * 2^k) and converts 9-digit chunks at the leaves.
+std::string to_decimal(const limb_t *a, size_t n, size_t width = 0);
+
+// Same digits as to_decimal, written to the stream in pieces of `chunk` characters as
+// the conversion produces them, so the whole string never exists in memory
+void write_decimal(std::ostream &stream, const limb_t *a, size_t n, size_t width = 0, size_t chunk = 1 << 16);
+
+// Value of the decimal digits[0 .. len) (characters '0' .. '9'), normalized. Short
+// inputs are accumulated 9 digits at a time, long ones split at powers 10^(9 * 2^k)
+// and combined as high * 10^(9 * 2^k) + low.
+std::vector<limb_t> from_decimal(const char *digits, size_t len);
+
+} // namespace limbs
+
+#endif // LIMBS_H
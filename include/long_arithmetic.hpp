@@ -4,8 +4,19 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <iosfwd>
+#include <type_traits>
 #include <utility>
 
+#include "limb_vector.hpp"
+#include "limbs.hpp"
+
+// Types taken by the single-word operators: unsigned integers of at most 32 bits.
+// Doubles and signed or wider integers convert to FixedPoint and use the full operators
+template <typename T>
+inline constexpr bool is_machine_word_v = std::is_integral_v<T> && std::is_unsigned_v<T> &&
+                                          !std::is_same_v<T, bool> && sizeof(T) <= sizeof(uint32_t);
+
 enum class Op_behavior {
     PLUS_FST,
     PLUS_SND,
@@ -15,11 +26,24 @@ enum class Op_behavior {
 
 class FixedPoint {
 public:
+    // Precomputed reciprocal of a divisor, reusable across many divisions
+    class Reciprocal;
+
     // Constructor: Converts a decimal string to binary representation with specified fractional bits
     FixedPoint(const std::string &num_str, int frac_bits = 32);
 
+    // Exact value of the double, bits below 2^-frac_bits are truncated like in the string
+    // constructor. Throws std::runtime_error for infinities and NaN.
     FixedPoint(const double &num, int frac_bits = 32);
 
+    // Native integers are stored directly, without a decimal round trip
+    FixedPoint(int64_t num, int frac_bits = 32);
+    FixedPoint(uint64_t num, int frac_bits = 32);
+
+    // Narrower integer types (int, unsigned, ...) go through the 64-bit constructors
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+    FixedPoint(T num, int frac_bits = 32)
+        : FixedPoint(static_cast<std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>(num), frac_bits) {}
 
     // Copy constructor and destructor
     FixedPoint(const FixedPoint& other);
@@ -28,11 +52,17 @@ public:
     // Assignment operator
     FixedPoint& operator=(const FixedPoint& other);
 
+    // Move constructor and move assignment, temporaries hand over their limbs
+    FixedPoint(FixedPoint&& other) noexcept;
+    FixedPoint& operator=(FixedPoint&& other) noexcept;
+
     // Overload the + operator for adding two FixedPoint numbers
-    FixedPoint operator+(const FixedPoint &other) const;
+    FixedPoint operator+(const FixedPoint &other) const &;
+    FixedPoint operator+(const FixedPoint &other) &&;
 
     // Overload the - operator for subtracting two FixedPoint numbers
-    FixedPoint operator-(const FixedPoint &other) const;
+    FixedPoint operator-(const FixedPoint &other) const &;
+    FixedPoint operator-(const FixedPoint &other) &&;
 
     // Overload the * operator for multiplying two FixedPoint numbers
     FixedPoint operator*(const FixedPoint &other) const;
@@ -40,6 +70,51 @@ public:
     // Overload the / operator
     FixedPoint operator/(const FixedPoint &other) const;
 
+    // Divides by a precomputed reciprocal, the result is the same as *this / divisor
+    FixedPoint operator/(const Reciprocal &other) const;
+
+    // Multiplies by a single machine word in one pass over the limbs
+    template <typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+    FixedPoint operator*(T other) const {
+        FixedPoint result = *this;
+        result.multiply_word(other);
+        return result;
+    }
+
+    // Divides by a single machine word in one pass over the limbs, the quotient keeps
+    // the fractional limbs of *this. Throws std::runtime_error for a zero divisor
+    template <typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+    FixedPoint operator/(T other) const {
+        FixedPoint result = *this;
+        result.divide_word(other);
+        return result;
+    }
+
+    // Remainder of the integer part of the magnitude divided by a machine word
+    template <typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+    uint32_t operator%(T other) const { return remainder_word(other); }
+
+    // Multiplies by 2^bits: whole limbs and the remaining bits move in one pass and
+    // fractional bits cross into the integer part. Exact, the same as * 2^bits
+    FixedPoint operator<<(size_t bits) const;
+
+    // Divides by 2^bits in one pass, the quotient keeps the fractional limbs of *this
+    // and is truncated toward zero like the word division
+    FixedPoint operator>>(size_t bits) const;
+
+    // One term of linear_combination(): value / div * mul, subtracted when negative
+    struct Term {
+        const FixedPoint *value;
+        uint32_t mul;
+        uint32_t div;
+        bool negative;
+    };
+
+    // Sum of the terms in a single accumulator, the same value as applying the word
+    // operators and +/- one by one: every division truncates at the precision of its
+    // operand, everything else is exact. Throws std::runtime_error for a zero divisor
+    static FixedPoint linear_combination(const Term *terms, size_t count);
+
     // Overload comparison operators for two FixedPoint numbers
     bool operator>(const FixedPoint &other) const;
 
@@ -61,61 +136,100 @@ public:
 
     FixedPoint& operator/=(const FixedPoint &other);
 
-    // Reduces the precision of the fractional part by removing bits and updating the fractional representation
+    template <typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+    FixedPoint& operator*=(T other) { return multiply_word(other); }
+
+    template <typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+    FixedPoint& operator/=(T other) { return divide_word(other); }
+
+    FixedPoint& operator<<=(size_t bits);
+
+    FixedPoint& operator>>=(size_t bits);
+
+    // Reduces the precision of the fractional part by removing bits and updating the fractional representation.
+    // A larger precision pads the fraction with zero limbs, e.g. to fix the precision of a quotient.
     void set_precision(size_t precision);
 
     void print_bin() const;
 
     std::string to_string(int len = -1) const;
 
+    // Streams the sign, the integer part, '.' and exactly frac_digits fractional digits
+    // (truncated) in chunks of `chunk` characters, without building the whole string
+    void write(std::ostream &out, size_t frac_digits, size_t chunk = 1 << 16) const;
+
+    // Versioned little-endian image of the exact state, laid out in serialization.hpp.
+    // read_binary throws std::runtime_error on a malformed or short image; FixedPointView
+    // reads the same image in place.
+    void write_binary(std::ostream &out) const;
+    static FixedPoint read_binary(std::istream &in);
+
 private:
-    std::vector<uint32_t> integer;    // Binary representation of the integer part
-    std::vector<uint32_t> fractional; // Binary representation of the fractional part
+    friend class FixedPointView;
+    template <size_t IntLimbs, size_t FracLimbs> friend class StaticFixedPoint;
+    friend FixedPoint sqrt(const FixedPoint &x, size_t precision);
+    friend FixedPoint rsqrt(const FixedPoint &x, size_t precision);
+    friend FixedPoint ldexp(const FixedPoint &x, ptrdiff_t exp);
+
+    LimbVector limb;                  // Magnitude, least significant first: the fractional limbs, then the integer ones
+    size_t frac_limbs = 0;            // Number of limbs below the radix point
     uint32_t fractional_bits;         // Number of fractional bits
     bool is_negative = false;         // Flag for negative numbers
 
+    // Builds a value from a computed magnitude with frac_sz fractional limbs and normalizes it
+    FixedPoint(LimbVector &&mag, size_t frac_sz, bool negative);
+
+    size_t int_limbs() const { return limb.size() - frac_limbs; }
+    const uint32_t *int_data() const { return limb.data() + frac_limbs; }
+
     bool is_zero() const;
 
-    Op_behavior helper(const FixedPoint &a, const FixedPoint &b, char op) const;
+    // Trims zero limbs around the number and updates fractional_bits
+    void normalize();
 
-    bool bigger_abs(const FixedPoint &a, const FixedPoint &b) const;
+    // Trims the zero integer limbs above the top one, keeping at least one
+    void trim_integer();
 
-    bool less_abs(const FixedPoint &a, const FixedPoint &b) const;
+    Op_behavior helper(const FixedPoint &a, const FixedPoint &b, char op) const;
+
+    // Compares the magnitudes aligned at the radix point: -1, 0 or 1
+    static int compare_abs(const FixedPoint &a, const FixedPoint &b);
 
     // Function to print bits of a uint32_t value
     void printBits(uint32_t value) const;
 
-    // Function to add fractional parts of two numbers
-    std::pair<std::vector<uint32_t>, bool> add_frac(const std::vector<uint32_t> &a,
-                                                    const std::vector<uint32_t> &b,
-                                                    uint32_t carry = 0) const;
+    // sqrt(x), or 1 / sqrt(x) when inverse, truncated to precision fractional bits
+    static FixedPoint square_root(const FixedPoint &x, size_t precision, bool inverse);
 
-    // Function to add integer parts of two numbers
-    std::pair<std::vector<uint32_t>, bool> add_int(const std::vector<uint32_t> &a,
-                                                   const std::vector<uint32_t> &b,
-                                                   uint32_t carry = 0) const;
+    // Moves the radix point to frac_sz >= frac_limbs limbs, the new low limbs are zero
+    void widen_fraction(size_t frac_sz);
 
-    std::pair<std::vector<uint32_t>, std::vector<uint32_t>>
-    subtract_nums(const FixedPoint &a, const FixedPoint &b) const;
+    // The word operators in place
+    FixedPoint& multiply_word(uint32_t other);
+    FixedPoint& divide_word(uint32_t other);
+    uint32_t remainder_word(uint32_t other) const;
 
-    // Function to perform subtraction of two 32-bit words with borrow
-    int subtract(uint32_t &res, uint32_t val_a, uint32_t val_b, uint32_t borrow = 0) const;
+    // Adds the magnitude of other to this one in place
+    void add_magnitude(const FixedPoint &other);
 
-    std::vector<uint32_t> subtract_vec(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b) const;
+    // Replaces this magnitude by the absolute difference, true if other was bigger
+    bool sub_magnitude(const FixedPoint &other);
 
-    std::pair<std::vector<uint32_t>, std::vector<uint32_t>>
-    divide(const FixedPoint &a, const FixedPoint &b) const;
+    // Product magnitude, its radix point lies after the fractional limbs of both operands
+    LimbVector multiply(const FixedPoint &other) const;
 
-    bool not_less_vec(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b) const;
+    // Whether division by divisor should go through a Newton reciprocal
+    bool use_reciprocal(const FixedPoint &divisor) const;
 
-    void add_bit_div(std::vector<uint32_t> &vec, uint32_t bit_added, bool is_one) const;
+    // Knuth's long division, the quotient keeps the fractional limbs of both operands
+    LimbVector divide(const FixedPoint &a, const FixedPoint &b) const;
+
+    // Same quotient as above through a precomputed Newton reciprocal
+    LimbVector divide(const FixedPoint &a, const Reciprocal &b) const;
 
     // Function to convert an integer part from decimal to binary
     std::vector<uint32_t> int_part_to_bin(const std::string& num_str) const;
 
-    // Function to multiply a decimal string by 2
-    std::string mult_by_two(const std::string &num_str) const;
-
     // Function to convert a fractional part from decimal to binary
     std::vector<uint32_t> frac_to_binary(const std::string &frac_str, int frac_bits = 32) const;
 
@@ -124,6 +238,35 @@ private:
     decimal_to_binary(const std::string &num_str, int frac_bits = 32) const;
 };
 
+// Newton reciprocal of a FixedPoint divisor. Build it once when many numbers are divided
+// by the same value: every division then costs about two multiplications
+class FixedPoint::Reciprocal {
+public:
+    explicit Reciprocal(const FixedPoint &divisor);
+
+private:
+    friend class FixedPoint;
+
+    limbs::Reciprocal inverse; // Reciprocal of the divisor magnitude
+    size_t frac_limbs;         // Fractional limbs of the divisor
+    bool is_negative;          // Sign of the divisor
+};
+
+// Square root truncated to precision fractional bits: the largest multiple of
+// 2^-precision whose square does not exceed x. Newton's iteration for 1 / sqrt(x) with
+// the working precision doubling every step, so the cost is a small multiple of one
+// multiplication at the final precision. Throws std::runtime_error for negative x
+FixedPoint sqrt(const FixedPoint &x, size_t precision);
+
+// 1 / sqrt(x) truncated to precision fractional bits, by the same iteration.
+// Throws std::runtime_error unless x is positive
+FixedPoint rsqrt(const FixedPoint &x, size_t precision);
+
+// x * 2^exp with no rounding in either direction: the radix point moves by whole limbs
+// and the magnitude by the remaining bits in one pass, so a negative exp adds
+// fractional limbs where >> would truncate
+FixedPoint ldexp(const FixedPoint &x, ptrdiff_t exp);
+
 // User-defined literal operator for creating FixedPoint objects
 FixedPoint operator""_long(long double number);
 
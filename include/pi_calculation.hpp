@@ -7,6 +7,28 @@ const std::string pi_right = "3.141592653589793238462643383279502884197169399375
 
 void CalcPi(FixedPoint &pi, const int k_start, const int k_finish, const FixedPoint &bs);
 
-FixedPoint get_pi();
+// pi with at least `digits` correct decimal places in to_string(), computed from the
+// Chudnovsky series by binary splitting. The splitting tree is evaluated by `threads`
+// work-stealing workers (0: all cores); the result is the same for any thread count.
+FixedPoint get_pi(size_t digits, unsigned threads = 1);
+
+// Same digits as get_pi, with the state of the series (the stack of finished ranges of
+// terms and their products) saved to checkpoint_path after every block of terms by a
+// background thread. With resume the computation continues from the checkpoint found
+// there, if any. The file is removed once pi is complete.
+FixedPoint get_pi(size_t digits, unsigned threads, const std::string &checkpoint_path, bool resume = false);
+
+// Continues the checkpointed series of get_pi from checkpoint_path (or starts it) for at
+// most `blocks` blocks of terms and leaves the checkpoint there, so a long computation can
+// be spread over several runs; get_pi with resume then finishes it. Returns true when
+// every term is done.
+bool advance_pi_checkpoint(size_t digits, unsigned threads, const std::string &checkpoint_path, uint64_t blocks);
+
+// `count` hexadecimal digits of pi starting `position` digits after the point, without
+// computing the earlier ones (Bailey-Borwein-Plouffe digit extraction with modular
+// exponentiation). pi_hex_digits(0, 8) == "243F6A88". The sum over k is split among
+// `threads` workers; a run of digits ending in a long string of F or 0 may be off by
+// a carry, as usual for BBP, so use it for spot checks.
+std::string pi_hex_digits(uint64_t position, size_t count, unsigned threads = 1);
 
 #endif // PI_CALC_H
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef SERIALIZATION_H
+#define SERIALIZATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "long_arithmetic.hpp"
+
+// Binary image of a FixedPoint written by FixedPoint::write_binary. All fields are
+// little-endian:
+//   offset  0  char[4]  magic "FXPT"
+//           4  uint16   format version, SERIAL_VERSION
+//           6  uint8    bits per limb, 32
+//           7  uint8    flags, bit 0: negative
+//           8  uint32   fractional_bits
+//          12  uint32   reserved, 0
+//          16  uint64   number of fractional limbs
+//          24  uint64   number of integer limbs
+//          32  limbs    the fractional limbs, then the integer limbs, least significant first,
+//                       plus one zero limb when their count is odd
+// Images stay multiples of 8 bytes, so the limbs of a mapped file (or of an image inside
+// a checkpoint) are aligned and can be used in place.
+constexpr uint16_t SERIAL_VERSION = 1;
+constexpr size_t SERIAL_HEADER_SIZE = 32;
+
+// The little-endian fields of the image, for formats that embed images: the low `bytes`
+// bytes of value, least significant first
+void store_le(unsigned char *dst, uint64_t value, size_t bytes);
+uint64_t load_le(const unsigned char *src, size_t bytes);
+
+// Read-only access to a serialized image owned by someone else (a buffer, a mapped
+// file). Nothing is copied, the image must outlive the view. Throws std::runtime_error
+// for a malformed, truncated or misaligned image, another format version, or on a
+// big-endian host where the limbs cannot be used in place.
+//
+// A view is not a FixedPoint operand: FixedPoint arithmetic needs to_fixed_point(),
+// which copies every limb. Only the limbs:: functions (cmp, mul, divmod, ...) work on
+// the mapped limbs directly, through fractional() and fractional_size() + integer_size().
+class FixedPointView {
+public:
+    FixedPointView(const void *data, size_t size);
+
+    bool is_negative() const { return negative; }
+    uint32_t fractional_bits() const { return frac_bits; }
+
+    // Limbs are least significant first; the fractional ones come right before the
+    // integer ones, so fractional() spans the whole magnitude
+    const uint32_t *fractional() const { return limbs; }
+    size_t fractional_size() const { return frac_sz; }
+    const uint32_t *integer() const { return limbs + frac_sz; }
+    size_t integer_size() const { return int_sz; }
+
+    // Bytes taken by the image; in a sequence of images the next one starts there
+    size_t image_size() const { return SERIAL_HEADER_SIZE + 8 * ((frac_sz + int_sz + 1) / 2); }
+
+    // Copies the limbs into an independent FixedPoint with the same state, O(size)
+    FixedPoint to_fixed_point() const;
+
+private:
+    const uint32_t *limbs;
+    bool negative;
+    uint32_t frac_bits;
+    size_t frac_sz;
+    size_t int_sz;
+};
+
+// A file holding one serialized FixedPoint, mapped read-only. Opening costs the same for
+// any size, the pages are read in on first access; computing with the value still
+// takes the copy of view().to_fixed_point().
+class MappedFixedPoint {
+public:
+    explicit MappedFixedPoint(const std::string &path);
+    ~MappedFixedPoint();
+
+    MappedFixedPoint(const MappedFixedPoint&) = delete;
+    MappedFixedPoint& operator=(const MappedFixedPoint&) = delete;
+
+    const FixedPointView &view() const { return image; }
+
+private:
+    // Maps the file and returns the address, size receives its length
+    static const void *map(const std::string &path, size_t &size);
+
+    size_t size = 0;
+    const void *data;
+    FixedPointView image;
+};
+
+#endif // SERIALIZATION_H
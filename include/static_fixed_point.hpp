@@ -0,0 +1,240 @@
+#ifndef STATIC_FIXED_POINT_H
+#define STATIC_FIXED_POINT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "long_arithmetic.hpp"
+
+// Fixed-point number with IntLimbs integer and FracLimbs fractional 32-bit limbs fixed at
+// compile time, for loops that run at one known precision. The limbs are a std::array
+// holding the value in two's complement, so there is no heap use, no size checks and no
+// trimming, and the loops over the limbs have constant trip counts the compiler unrolls.
+// All arithmetic is constexpr. Results that do not fit the integer limbs wrap around;
+// products and quotients are truncated toward zero to FracLimbs fractional limbs.
+template <size_t IntLimbs, size_t FracLimbs>
+class StaticFixedPoint {
+    static_assert(IntLimbs >= 1, "the sign lives in the integer limbs");
+
+public:
+    static constexpr size_t LIMBS = IntLimbs + FracLimbs;
+
+    constexpr StaticFixedPoint() = default;
+
+    constexpr explicit StaticFixedPoint(int64_t num) {
+        uint64_t bits = static_cast<uint64_t>(num);
+        for (size_t i = 0; i < IntLimbs; i++) {
+            limb[FracLimbs + i] = i < 2 ? static_cast<uint32_t>(bits >> (32 * i)) : (num < 0 ? 0xFFFFFFFFu : 0);
+        }
+    }
+
+    // Truncates the fraction to FracLimbs limbs, throws std::overflow_error when the
+    // integer part does not fit
+    explicit StaticFixedPoint(const FixedPoint &num) {
+        size_t fi = num.frac_limbs;
+        for (size_t i = 0; i < FracLimbs && i < fi; i++) {
+            limb[FracLimbs - 1 - i] = num.limb[fi - 1 - i];
+        }
+        const uint32_t *integer = num.int_data();
+        size_t int_sz = limbs::normalized_size(integer, num.int_limbs());
+        if (int_sz > IntLimbs || (int_sz == IntLimbs && integer[IntLimbs - 1] >> 31)) {
+            throw std::overflow_error("FixedPoint does not fit into " + std::to_string(IntLimbs) + " integer limbs");
+        }
+        for (size_t i = 0; i < int_sz; i++) {
+            limb[FracLimbs + i] = integer[i];
+        }
+        if (num.is_negative) {
+            negate(limb);
+        }
+    }
+
+    explicit operator FixedPoint() const {
+        std::array<uint32_t, LIMBS> mag = magnitude();
+        return FixedPoint(LimbVector(mag.data(), mag.data() + LIMBS), FracLimbs, is_negative());
+    }
+
+    std::string to_string(int len = -1) const {
+        return FixedPoint(*this).to_string(len);
+    }
+
+    constexpr bool is_negative() const { return limb[LIMBS - 1] >> 31; }
+
+    // Two's complement limbs, least significant first
+    constexpr const std::array<uint32_t, LIMBS> &limbs() const { return limb; }
+
+    constexpr StaticFixedPoint &operator+=(const StaticFixedPoint &other) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            carry += uint64_t(limb[i]) + other.limb[i];
+            limb[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return *this;
+    }
+
+    constexpr StaticFixedPoint &operator-=(const StaticFixedPoint &other) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t diff = uint64_t(limb[i]) - other.limb[i] - borrow;
+            limb[i] = static_cast<uint32_t>(diff);
+            borrow = diff >> 63;
+        }
+        return *this;
+    }
+
+    constexpr StaticFixedPoint &operator*=(const StaticFixedPoint &other) {
+        return *this = *this * other;
+    }
+
+    // Words are unsigned integers of at most 32 bits, anything else does not compile
+    template <typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+    constexpr StaticFixedPoint &operator*=(T other) {
+        bool negative = is_negative();
+        std::array<uint32_t, LIMBS> mag = magnitude();
+        uint64_t carry = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            carry += uint64_t(mag[i]) * other;
+            mag[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+        return assign(mag, negative);
+    }
+
+    // Truncates toward zero, throws std::runtime_error for a zero divisor
+    template <typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+    constexpr StaticFixedPoint &operator/=(T other) {
+        if (other == 0) {
+            throw std::runtime_error("Attempted division by zero");
+        }
+        bool negative = is_negative();
+        std::array<uint32_t, LIMBS> mag = magnitude();
+        uint64_t rem = 0;
+        for (size_t i = LIMBS; i-- > 0;) {
+            uint64_t cur = (rem << 32) | mag[i];
+            mag[i] = static_cast<uint32_t>(cur / other);
+            rem = cur % other;
+        }
+        return assign(mag, negative);
+    }
+
+    // Multiplies by 2^bits, wrapping around like the word product. Two's complement
+    // shifts left the same way for both signs
+    constexpr StaticFixedPoint &operator<<=(size_t bits) {
+        size_t shift_limbs = bits / 32;
+        unsigned shift = bits % 32;
+        for (size_t i = LIMBS; i-- > 0;) {
+            uint32_t cur = i >= shift_limbs ? limb[i - shift_limbs] << shift : 0;
+            if (shift && i > shift_limbs) {
+                cur |= limb[i - shift_limbs - 1] >> (32 - shift);
+            }
+            limb[i] = cur;
+        }
+        return *this;
+    }
+
+    // Divides by 2^bits, truncated toward zero like the word division
+    constexpr StaticFixedPoint &operator>>=(size_t bits) {
+        bool negative = is_negative();
+        std::array<uint32_t, LIMBS> mag = magnitude();
+        size_t shift_limbs = bits / 32;
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t pair = i + shift_limbs < LIMBS ? mag[i + shift_limbs] : 0;
+            if (i + shift_limbs + 1 < LIMBS) {
+                pair |= uint64_t(mag[i + shift_limbs + 1]) << 32;
+            }
+            mag[i] = static_cast<uint32_t>(pair >> (bits % 32));
+        }
+        return assign(mag, negative);
+    }
+
+    constexpr StaticFixedPoint operator-() const {
+        StaticFixedPoint result = *this;
+        negate(result.limb);
+        return result;
+    }
+
+    friend constexpr StaticFixedPoint operator+(StaticFixedPoint a, const StaticFixedPoint &b) { return a += b; }
+    friend constexpr StaticFixedPoint operator-(StaticFixedPoint a, const StaticFixedPoint &b) { return a -= b; }
+    template <typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+    friend constexpr StaticFixedPoint operator*(StaticFixedPoint a, T b) { return a *= b; }
+    template <typename T, typename = std::enable_if_t<is_machine_word_v<T>>>
+    friend constexpr StaticFixedPoint operator/(StaticFixedPoint a, T b) { return a /= b; }
+    friend constexpr StaticFixedPoint operator<<(StaticFixedPoint a, size_t bits) { return a <<= bits; }
+    friend constexpr StaticFixedPoint operator>>(StaticFixedPoint a, size_t bits) { return a >>= bits; }
+
+    // Schoolbook product of the magnitudes, the limbs below the radix point are dropped
+    friend constexpr StaticFixedPoint operator*(const StaticFixedPoint &a, const StaticFixedPoint &b) {
+        std::array<uint32_t, LIMBS> x = a.magnitude(), y = b.magnitude();
+        std::array<uint32_t, 2 * LIMBS> product{};
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < LIMBS; j++) {
+                carry += uint64_t(x[i]) * y[j] + product[i + j];
+                product[i + j] = static_cast<uint32_t>(carry);
+                carry >>= 32;
+            }
+            product[i + LIMBS] = static_cast<uint32_t>(carry);
+        }
+
+        std::array<uint32_t, LIMBS> mag{};
+        for (size_t i = 0; i < LIMBS; i++) {
+            mag[i] = product[FracLimbs + i];
+        }
+        StaticFixedPoint result;
+        return result.assign(mag, a.is_negative() != b.is_negative());
+    }
+
+    friend constexpr bool operator==(const StaticFixedPoint &a, const StaticFixedPoint &b) {
+        for (size_t i = 0; i < LIMBS; i++) {
+            if (a.limb[i] != b.limb[i]) return false;
+        }
+        return true;
+    }
+
+    friend constexpr bool operator<(const StaticFixedPoint &a, const StaticFixedPoint &b) {
+        if (a.is_negative() != b.is_negative()) return a.is_negative();
+        for (size_t i = LIMBS; i-- > 0;) {
+            if (a.limb[i] != b.limb[i]) return a.limb[i] < b.limb[i];
+        }
+        return false;
+    }
+
+    friend constexpr bool operator!=(const StaticFixedPoint &a, const StaticFixedPoint &b) { return !(a == b); }
+    friend constexpr bool operator>(const StaticFixedPoint &a, const StaticFixedPoint &b) { return b < a; }
+    friend constexpr bool operator<=(const StaticFixedPoint &a, const StaticFixedPoint &b) { return !(b < a); }
+    friend constexpr bool operator>=(const StaticFixedPoint &a, const StaticFixedPoint &b) { return !(a < b); }
+
+private:
+    // Two's complement negation in place
+    static constexpr void negate(std::array<uint32_t, LIMBS> &x) {
+        uint64_t carry = 1;
+        for (size_t i = 0; i < LIMBS; i++) {
+            carry += uint32_t(~x[i]);
+            x[i] = static_cast<uint32_t>(carry);
+            carry >>= 32;
+        }
+    }
+
+    constexpr std::array<uint32_t, LIMBS> magnitude() const {
+        std::array<uint32_t, LIMBS> mag = limb;
+        if (is_negative()) {
+            negate(mag);
+        }
+        return mag;
+    }
+
+    constexpr StaticFixedPoint &assign(const std::array<uint32_t, LIMBS> &mag, bool negative) {
+        limb = mag;
+        if (negative) {
+            negate(limb);
+        }
+        return *this;
+    }
+
+    std::array<uint32_t, LIMBS> limb{};
+};
+
+#endif // STATIC_FIXED_POINT_H
@@ -0,0 +1,62 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class LimbAllocator;
+
+// Fork-join pool with work stealing for recursive computations such as binary splitting.
+// Every worker owns a deque: it pushes and pops its own tasks at the back, idle workers
+// steal the oldest (largest) tasks from the front of the others. The thread calling
+// run() takes part as worker 0 for the duration of the call.
+class TaskPool {
+public:
+    // threads counts the calling thread, 0 picks std::thread::hardware_concurrency()
+    explicit TaskPool(unsigned threads = 1);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    unsigned threads() const { return static_cast<unsigned>(queues.size()); }
+
+    // Runs root on the calling thread with the pool available to fork_join
+    void run(const std::function<void()> &root);
+
+    // Runs left here and offers right to idle workers, returns once both have finished.
+    // Outside of run() or with a single thread both simply run one after the other.
+    // An exception thrown by either side is rethrown here after both are done.
+    void fork_join(const std::function<void()> &left, const std::function<void()> &right);
+
+private:
+    struct Task {
+        const std::function<void()> *fn;
+        LimbAllocator *allocator; // Limb allocator of the forking thread, the task uses it too
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+    };
+
+    struct Queue {
+        std::mutex lock;
+        std::deque<Task *> tasks;
+    };
+
+    void worker_loop(size_t index);
+    Task *steal(size_t thief);
+    static void execute(Task *task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<bool> active{false};
+    std::atomic<bool> stopping{false};
+};
+
+#endif // TASK_POOL_H
@@ -1,30 +1,108 @@
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <chrono>
+#include <algorithm>
+#include <thread>
 
 #include "../include/long_arithmetic.hpp"
 #include "../include/pi_calculation.hpp"
 
+// Usage:
+//   pi <len> [--threads N] [--output FILE] [--checkpoint FILE] [--resume]
+//                                              decimal digits of pi, streamed to FILE if given
+//   pi --hex <position> <count> [--threads N]  hex digits starting after <position> digits
 int main(int argc, char** argv) {
     if (argc == 1) {
         printf("No arguments provided.\n");
         return 0;
     }
     try {
-        int len = std::stoi(argv[1]);
+        bool hex_mode = std::string(argv[1]) == "--hex";
+        if (hex_mode && argc < 4) {
+            std::cerr << "Error: --hex needs a position and a digit count." << std::endl;
+            return 1;
+        }
+
+        int len = hex_mode ? 0 : std::stoi(argv[1]);
+        if (len < 0) {
+            std::cerr << "Error: The number of digits cannot be negative." << std::endl;
+            return 1;
+        }
+        uint64_t position = hex_mode ? std::stoull(argv[2]) : 0;
+        size_t count = hex_mode ? std::stoull(argv[3]) : 0;
+
+        // Options: --threads N evaluates the series on N workers (0: all cores,
+        // at most four per core), --output FILE writes the digits to FILE while converting them,
+        // --checkpoint FILE saves the progress there, --resume continues from it
+        unsigned threads = 1;
+        std::string output;
+        std::string checkpoint;
+        bool resume = false;
+        for (int i = hex_mode ? 4 : 2; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--threads" && i + 1 < argc) {
+                long requested = std::stol(argv[++i]);
+                if (requested < 0) {
+                    std::cerr << "Error: The number of threads cannot be negative." << std::endl;
+                    return 1;
+                }
+                // More workers than a few per core only cost memory and switches
+                unsigned limit = 4 * std::max(1u, std::thread::hardware_concurrency());
+                threads = static_cast<unsigned>(std::min<long>(requested, limit));
+            } else if (arg == "--output" && i + 1 < argc && !hex_mode) {
+                output = argv[++i];
+            } else if (arg == "--checkpoint" && i + 1 < argc && !hex_mode) {
+                checkpoint = argv[++i];
+            } else if (arg == "--resume" && !hex_mode) {
+                resume = true;
+            } else {
+                std::cerr << "Error: Unknown option " << arg << std::endl;
+                return 1;
+            }
+        }
 
         auto start = std::chrono::high_resolution_clock::now();
-        FixedPoint pi = get_pi();
+        if (hex_mode) {
+            std::string digits = pi_hex_digits(position, count, threads);
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>
+                           (std::chrono::high_resolution_clock::now() - start);
+            std::cout << digits << std::endl;
+            std::cout << "Total time (in ms) " << duration.count() << std::endl;
+            return 0;
+        }
+
+        if (resume && checkpoint.empty()) {
+            checkpoint = "pi.checkpoint";
+        }
+        FixedPoint pi = checkpoint.empty() ? get_pi(len, threads) : get_pi(len, threads, checkpoint, resume);
         auto duration = std::chrono::duration_cast<std::chrono::milliseconds>
                        (std::chrono::high_resolution_clock::now() - start);
-        std::string pi_str = pi.to_string();
-        pi_str.resize(len + 2);
-        std::cout << pi_str << std::endl;
+        if (!output.empty()) {
+            std::ofstream file(output, std::ios::binary);
+            if (!file) {
+                std::cerr << "Error: Cannot open " << output << std::endl;
+                return 1;
+            }
+            pi.write(file, len);
+            file << '\n';
+            std::cout << "Digits written to " << output << std::endl;
+        } else {
+            pi.write(std::cout, len);
+            std::cout << std::endl;
+        }
         std::cout << "Total time (in ms) " << duration.count() << std::endl;
 
     } catch (const std::invalid_argument& e) {
         std::cerr << "Error: Invalid input." << std::endl;
+    } catch (const std::out_of_range& e) {
+        std::cerr << "Error: Number out of range." << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        // Unreadable checkpoints, failed checkpoint writes
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
     }
 
     return 0;
-}
\ No newline at end of file
+}
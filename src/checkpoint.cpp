@@ -0,0 +1,71 @@
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include "../include/checkpoint.hpp"
+
+CheckpointWriter::CheckpointWriter(std::string path)
+    : file_path(std::move(path)), worker(&CheckpointWriter::loop, this) {}
+
+CheckpointWriter::~CheckpointWriter() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void CheckpointWriter::submit(std::function<void(std::ostream &)> snapshot) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        pending = std::move(snapshot);
+    }
+    wake.notify_one();
+}
+
+void CheckpointWriter::flush() {
+    std::unique_lock<std::mutex> guard(lock);
+    idle.wait(guard, [this] { return !pending && !busy; });
+    if (error) {
+        std::exception_ptr failed = error;
+        error = nullptr;
+        std::rethrow_exception(failed);
+    }
+}
+
+void CheckpointWriter::loop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this] { return pending || stopping; });
+        if (!pending) break;
+
+        std::function<void(std::ostream &)> snapshot = std::move(pending);
+        pending = nullptr;
+        busy = true;
+        guard.unlock();
+
+        try {
+            std::string tmp_path = file_path + ".tmp";
+            {
+                std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+                snapshot(out);
+                out.flush();
+                if (!out) throw std::runtime_error("Cannot write checkpoint " + tmp_path);
+            }
+            if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+                throw std::runtime_error("Cannot replace checkpoint " + file_path);
+            }
+        } catch (...) {
+            guard.lock();
+            error = std::current_exception();
+            guard.unlock();
+        }
+
+        // The closure may hold the last reference to large state, release it unlocked
+        snapshot = nullptr;
+        guard.lock();
+        busy = false;
+        idle.notify_all();
+    }
+}
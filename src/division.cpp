@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "../include/limbs.hpp"
+
+namespace limbs {
+
+namespace {
+
+__extension__ typedef unsigned __int128 u128; // -pedantic knows no 128-bit integers
+
+// x[0 .. n) -= 1
+void decrement(limb_t *x, size_t n) {
+    for (size_t i = 0; i < n && x[i]-- == 0; i++) {}
+}
+
+// x[0 .. n) += 1
+void increment(limb_t *x, size_t n) {
+    for (size_t i = 0; i < n && ++x[i] == 0; i++) {}
+}
+
+// Newton iteration with precision doubling (Brent and Zimmermann, "Modern Computer
+// Arithmetic", algorithm ApproximateReciprocal). For a normalized a[0 .. n) writes
+// x[0 .. n + 1) = B^n + ... such that a * x < B^2n <= a * (x + 2)
+void approx_reciprocal(limb_t *x, const limb_t *a, size_t n) {
+    if (n <= 2) {
+        // floor((B^2n - 1) / a) computed directly
+        u128 num = n == 1 ? (static_cast<u128>(1) << (2 * LIMB_BITS)) - 1 : ~static_cast<u128>(0);
+        u128 den = n == 1 ? a[0] : (static_cast<u128>(a[1]) << LIMB_BITS) | a[0];
+        u128 q = num / den;
+        for (size_t i = 0; i <= n; i++) {
+            x[i] = static_cast<limb_t>(q >> (LIMB_BITS * i));
+        }
+        return;
+    }
+
+    size_t l = (n - 1) / 2;
+    size_t h = n - l;
+
+    // Reciprocal of the top half
+    std::vector<limb_t> xh(h + 1);
+    approx_reciprocal(xh.data(), a + l, h);
+
+    // t = a * xh, brought below B^(n + h)
+    std::vector<limb_t> t(n + h + 1);
+    mul(t.data(), a, n, xh.data(), h + 1);
+    while (t[n + h] != 0) {
+        decrement(xh.data(), h + 1);
+        sub(t.data(), t.data(), n + h + 1, a, n);
+    }
+
+    // t = B^(n + h) - t, the error of the half-size reciprocal
+    for (size_t i = 0; i < n + h; i++) t[i] = ~t[i];
+    increment(t.data(), n + h);
+
+    // Correction u = (t / B^l) * xh, of which the part above B^(2h - l) is added
+    size_t tm_n = n + h - l;
+    std::vector<limb_t> u(tm_n + h + 1);
+    mul(u.data(), t.data() + l, tm_n, xh.data(), h + 1);
+
+    std::fill(x, x + l, 0);
+    std::copy(xh.begin(), xh.end(), x + l);
+    size_t drop = 2 * h - l;
+    size_t u_len = normalized_size(u.data() + drop, u.size() - drop);
+    if (u_len > 0) add(x, x, n + 1, u.data() + drop, std::min(u_len, n + 1));
+}
+
+} // namespace
+
+// Knuth, TAOCP vol. 2, 4.3.1, Algorithm D. Every step estimates one quotient limb from
+// the top two limbs of the remainder and the top limb of the normalized divisor, the
+// estimate is at most 2 too large and is fixed against the second divisor limb
+void divmod_basecase(limb_t *q, limb_t *r, const limb_t *a, size_t an, const limb_t *d, size_t dn) {
+    size_t n = normalized_size(d, dn);
+    if (n == 0) {
+        throw std::runtime_error("Attempted division by zero");
+    }
+
+    if (an < n) {
+        if (r) {
+            std::copy(a, a + an, r);
+            std::fill(r + an, r + n, 0);
+        }
+        return;
+    }
+
+    if (n == 1) {
+        limb_t rem = divmod_1(q, a, an, d[0]);
+        if (r) r[0] = rem;
+        return;
+    }
+
+    // Normalize so that the top bit of the divisor is set
+    unsigned shift = __builtin_clz(d[n - 1]) - (32 - LIMB_BITS);
+    std::vector<limb_t> vn(n + 1), un(an + 1);
+    vn[n] = lshift(vn.data(), d, n, shift);
+    un[an] = lshift(un.data(), a, an, shift);
+
+    const dlimb_t base = static_cast<dlimb_t>(1) << LIMB_BITS;
+    const dlimb_t mask = base - 1;
+
+    for (size_t j = an - n + 1; j-- > 0;) {
+        dlimb_t num = (static_cast<dlimb_t>(un[j + n]) << LIMB_BITS) | un[j + n - 1];
+        dlimb_t qhat = num / vn[n - 1];
+        dlimb_t rhat = num % vn[n - 1];
+
+        while (qhat >= base || qhat * vn[n - 2] > ((rhat << LIMB_BITS) | un[j + n - 2])) {
+            qhat--;
+            rhat += vn[n - 1];
+            if (rhat >= base) break;
+        }
+
+        // un[j .. j + n] -= qhat * vn
+        int64_t borrow = 0, t = 0;
+        for (size_t i = 0; i < n; i++) {
+            dlimb_t p = qhat * vn[i];
+            t = static_cast<int64_t>(un[i + j]) - borrow - static_cast<int64_t>(p & mask);
+            un[i + j] = static_cast<limb_t>(t);
+            borrow = static_cast<int64_t>(p >> LIMB_BITS) - (t >> LIMB_BITS);
+        }
+        t = static_cast<int64_t>(un[j + n]) - borrow;
+        un[j + n] = static_cast<limb_t>(t);
+
+        // The estimate was one too large: add the divisor back
+        if (t < 0) {
+            qhat--;
+            un[j + n] += add_n(un.data() + j, un.data() + j, vn.data(), n);
+        }
+        q[j] = static_cast<limb_t>(qhat);
+    }
+
+    if (r) rshift(r, un.data(), n, shift);
+}
+
+DivThresholds &div_thresholds() {
+    static DivThresholds thresholds;
+    return thresholds;
+}
+
+Reciprocal::Reciprocal(const limb_t *d, size_t dn) {
+    size_t n = normalized_size(d, dn);
+    if (n == 0) {
+        throw std::runtime_error("Attempted division by zero");
+    }
+
+    shift = __builtin_clz(d[n - 1]) - (32 - LIMB_BITS);
+    divisor.resize(n);
+    lshift(divisor.data(), d, n, shift);
+
+    inverse.resize(n + 1);
+    approx_reciprocal(inverse.data(), divisor.data(), n);
+}
+
+void divmod(limb_t *q, limb_t *r, const limb_t *a, size_t an, const Reciprocal &inv) {
+    const std::vector<limb_t> &d = inv.divisor;
+    size_t n = d.size();
+
+    if (an < n) {
+        if (r) {
+            std::copy(a, a + an, r);
+            std::fill(r + an, r + n, 0);
+        }
+        return;
+    }
+
+    // The dividend is shifted like the divisor so the quotient stays the same
+    size_t len = an + 1;
+    std::vector<limb_t> num(len);
+    num[an] = lshift(num.data(), a, an, inv.shift);
+
+    // Schoolbook division in base B^n: every step divides rem * B^s + next s limbs
+    // (below d * B^s <= B^2n) with a Barrett estimate that is at most 3 too small
+    std::vector<limb_t> quot(len, 0);
+    std::vector<limb_t> rem(2 * n + 1, 0), top(2 * n + 2), est(2 * n + 1), prod(2 * n);
+    size_t rem_len = 0; // rem[0 .. rem_len) < d
+
+    for (size_t pos = len; pos > 0;) {
+        size_t s = std::min(n, pos);
+        pos -= s;
+
+        // c = rem * B^s + num[pos .. pos + s)
+        std::copy_backward(rem.begin(), rem.begin() + rem_len, rem.begin() + s + rem_len);
+        std::copy(num.begin() + pos, num.begin() + pos + s, rem.begin());
+        size_t c_len = s + rem_len;
+        std::fill(rem.begin() + c_len, rem.end(), 0);
+
+        // qhat = floor(floor(c / B^(n - 1)) * inverse / B^(n + 1)), never above c / d
+        limb_t *qhat = quot.data() + pos;
+        if (c_len >= n) {
+            size_t c_hi = c_len - (n - 1);
+            mul(top.data(), rem.data() + n - 1, c_hi, inv.inverse.data(), n + 1);
+            std::copy(top.begin() + n + 1, top.begin() + n + 1 + std::min(c_hi, s), qhat);
+
+            // c -= qhat * d
+            mul(prod.data(), qhat, s, d.data(), n);
+            sub(rem.data(), rem.data(), c_len, prod.data(), std::min(c_len, s + n));
+        }
+
+        // At most a few corrections, each adds one to qhat
+        while (cmp(rem.data(), n + 1, d.data(), n) >= 0) {
+            sub(rem.data(), rem.data(), n + 1, d.data(), n);
+            increment(qhat, s);
+        }
+        rem_len = n;
+    }
+
+    std::copy(quot.begin(), quot.begin() + (an - n + 1), q);
+    if (r) rshift(r, rem.data(), n, inv.shift);
+}
+
+} // namespace limbs
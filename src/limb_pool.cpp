@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <thread>
+
+#include "../include/limb_pool.hpp"
+
+namespace {
+
+// Chunks are the unit the pool takes from and returns to the global heap
+constexpr size_t CHUNK_BYTES = size_t(1) << 20;
+
+// Size classes MIN_CLASS, 2 * MIN_CLASS, ..., MAX_CLASS limbs
+constexpr size_t CLASSES = 14;
+static_assert((LimbPool::MIN_CLASS << (CLASSES - 1)) == LimbPool::MAX_CLASS, "size classes");
+
+std::atomic<uint64_t> next_pool_id{1};
+
+// The cache this thread used last and the id of its pool. Ids are never reused, so a
+// slot left behind by a destroyed pool never matches again.
+thread_local uint64_t last_pool = 0;
+thread_local void *last_cache = nullptr;
+
+size_t class_of(size_t n) {
+    size_t size_class = 0;
+    while ((LimbPool::MIN_CLASS << size_class) < n) {
+        size_class++;
+    }
+    return size_class;
+}
+
+} // namespace
+
+// Header in front of every buffer; while a block is free, its first limbs link it to
+// the next one of the free list
+struct LimbPool::Block {
+    Cache *owner;      // nullptr for buffers from the global heap
+    size_t size_class;
+};
+
+struct LimbPool::Cache {
+    std::thread::id thread;
+    Block *free[CLASSES] = {};
+    std::atomic<Block *> remote{nullptr}; // Freed by other threads, not sorted yet
+    char *bump = nullptr;                 // Unused rest of the current chunk
+    size_t left = 0;
+};
+
+LimbPool::LimbPool() : id(next_pool_id.fetch_add(1)) {}
+
+LimbPool::~LimbPool() {
+    reset();
+}
+
+uint32_t *LimbPool::allocate(size_t &n) {
+    if (n > MAX_CLASS) {
+        Block *block = static_cast<Block *>(::operator new(sizeof(Block) + n * sizeof(uint32_t)));
+        block->owner = nullptr;
+        block->size_class = 0;
+        return reinterpret_cast<uint32_t *>(block + 1);
+    }
+
+    size_t size_class = class_of(n);
+    Cache &cache = local_cache();
+    if (!cache.free[size_class] && cache.remote.load(std::memory_order_relaxed)) {
+        // Sort the buffers other threads have given back into the free lists
+        Block *list = cache.remote.exchange(nullptr, std::memory_order_acquire);
+        while (list) {
+            Block *rest = next(list);
+            next(list) = cache.free[list->size_class];
+            cache.free[list->size_class] = list;
+            list = rest;
+        }
+    }
+
+    Block *block = cache.free[size_class];
+    if (block) {
+        cache.free[size_class] = next(block);
+    } else {
+        block = carve(cache, size_class);
+    }
+    n = MIN_CLASS << size_class;
+    return reinterpret_cast<uint32_t *>(block + 1);
+}
+
+void LimbPool::deallocate(uint32_t *p, size_t) {
+    Block *block = reinterpret_cast<Block *>(p) - 1;
+    Cache *owner = block->owner;
+    if (!owner) {
+        ::operator delete(block);
+    } else if (last_pool == id && last_cache == owner) {
+        next(block) = owner->free[block->size_class];
+        owner->free[block->size_class] = block;
+    } else {
+        Block *head = owner->remote.load(std::memory_order_relaxed);
+        do {
+            next(block) = head;
+        } while (!owner->remote.compare_exchange_weak(head, block, std::memory_order_release,
+                                                      std::memory_order_relaxed));
+    }
+}
+
+void LimbPool::reset() {
+    std::lock_guard<std::mutex> guard(lock);
+    for (void *chunk : chunks) {
+        ::operator delete(chunk);
+    }
+    chunks.clear();
+    for (auto &cache : caches) {
+        std::fill(std::begin(cache->free), std::end(cache->free), nullptr);
+        cache->remote.store(nullptr);
+        cache->bump = nullptr;
+        cache->left = 0;
+    }
+}
+
+size_t LimbPool::reserved() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return chunks.size() * CHUNK_BYTES;
+}
+
+LimbPool::Cache &LimbPool::local_cache() {
+    if (last_pool == id) {
+        return *static_cast<Cache *>(last_cache);
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    std::thread::id self = std::this_thread::get_id();
+    Cache *cache = nullptr;
+    for (auto &candidate : caches) {
+        if (candidate->thread == self) {
+            cache = candidate.get();
+        }
+    }
+    if (!cache) {
+        caches.push_back(std::make_unique<Cache>());
+        cache = caches.back().get();
+        cache->thread = self;
+    }
+    last_pool = id;
+    last_cache = cache;
+    return *cache;
+}
+
+LimbPool::Block *&LimbPool::next(Block *block) {
+    return *reinterpret_cast<Block **>(block + 1);
+}
+
+LimbPool::Block *LimbPool::carve(Cache &cache, size_t size_class) {
+    size_t bytes = sizeof(Block) + (MIN_CLASS << size_class) * sizeof(uint32_t);
+    if (cache.left < bytes) {
+        // The rest of the old chunk is too small and stays unused until reset()
+        std::lock_guard<std::mutex> guard(lock);
+        chunks.push_back(::operator new(CHUNK_BYTES));
+        cache.bump = static_cast<char *>(chunks.back());
+        cache.left = CHUNK_BYTES;
+    }
+
+    Block *block = reinterpret_cast<Block *>(cache.bump);
+    cache.bump += bytes;
+    cache.left -= bytes;
+    block->owner = &cache;
+    block->size_class = size_class;
+    return block;
+}
@@ -0,0 +1,155 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "../include/limb_vector.hpp"
+
+namespace {
+
+thread_local LimbAllocator *current_allocator = nullptr;
+
+// A heap buffer starts with the allocator that owns it, the limbs follow
+constexpr size_t HEADER_LIMBS = sizeof(LimbAllocator *) / sizeof(uint32_t);
+
+} // namespace
+
+LimbAllocator *LimbAllocator::current() {
+    return current_allocator;
+}
+
+ScopedLimbAllocator::ScopedLimbAllocator(LimbAllocator *allocator) : saved(current_allocator) {
+    current_allocator = allocator;
+}
+
+ScopedLimbAllocator::~ScopedLimbAllocator() {
+    current_allocator = saved;
+}
+
+LimbVector::LimbVector(size_t n, uint32_t value) {
+    assign(n, value);
+}
+
+LimbVector::LimbVector(const uint32_t *first, const uint32_t *last) {
+    assign(first, last);
+}
+
+LimbVector::LimbVector(const LimbVector &other) {
+    assign(other.begin(), other.end());
+}
+
+// A heap buffer changes hands, inline limbs are copied
+LimbVector::LimbVector(LimbVector &&other) noexcept : sz(other.sz), cap(other.cap) {
+    if (other.is_inline()) {
+        std::memcpy(local, other.local, sz * sizeof(uint32_t));
+    } else {
+        heap = other.heap;
+        other.cap = INLINE_LIMBS;
+    }
+    other.sz = 0;
+}
+
+LimbVector &LimbVector::operator=(const LimbVector &other) {
+    if (this != &other) {
+        assign(other.begin(), other.end());
+    }
+    return *this;
+}
+
+LimbVector &LimbVector::operator=(LimbVector &&other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    release();
+    sz = other.sz;
+    cap = other.cap;
+    if (other.is_inline()) {
+        std::memcpy(local, other.local, sz * sizeof(uint32_t));
+    } else {
+        heap = other.heap;
+        other.cap = INLINE_LIMBS;
+    }
+    other.sz = 0;
+    return *this;
+}
+
+LimbVector::~LimbVector() {
+    release();
+}
+
+void LimbVector::resize(size_t n, uint32_t value) {
+    reserve(n);
+    if (n > sz) {
+        std::fill(data() + sz, data() + n, value);
+    }
+    sz = n;
+}
+
+void LimbVector::assign(size_t n, uint32_t value) {
+    reserve(n);
+    std::fill(data(), data() + n, value);
+    sz = n;
+}
+
+// The source must not lie inside this vector
+void LimbVector::assign(const uint32_t *first, const uint32_t *last) {
+    size_t n = last - first;
+    if (n > cap) {
+        // Nothing to keep, so the old buffer goes before the new one is filled
+        sz = 0;
+        grow(n);
+    }
+    if (n != 0) {
+        std::memcpy(data(), first, n * sizeof(uint32_t));
+    }
+    sz = n;
+}
+
+LimbVector::iterator LimbVector::insert(const_iterator pos, size_t n, uint32_t value) {
+    size_t index = pos - data();
+    if (sz + n > cap) {
+        grow(std::max(sz + n, 2 * cap));
+    }
+    uint32_t *at = data() + index;
+    std::memmove(at + n, at, (sz - index) * sizeof(uint32_t));
+    std::fill(at, at + n, value);
+    sz += n;
+    return at;
+}
+
+LimbVector::iterator LimbVector::erase(const_iterator first, const_iterator last) {
+    uint32_t *at = data() + (first - data());
+    size_t n = last - first;
+    std::memmove(at, at + n, (end() - last) * sizeof(uint32_t));
+    sz -= n;
+    return at;
+}
+
+void LimbVector::grow(size_t new_cap) {
+    LimbAllocator *allocator = current_allocator;
+    size_t block_sz = new_cap + HEADER_LIMBS;
+    uint32_t *block = allocator ? allocator->allocate(block_sz)
+                                : static_cast<uint32_t *>(::operator new(block_sz * sizeof(uint32_t)));
+    std::memcpy(block, &allocator, sizeof allocator);
+
+    uint32_t *buffer = block + HEADER_LIMBS;
+    if (sz != 0) {
+        std::memcpy(buffer, data(), sz * sizeof(uint32_t));
+    }
+    release();
+    heap = buffer;
+    cap = block_sz - HEADER_LIMBS;
+}
+
+void LimbVector::release() {
+    if (is_inline()) {
+        return;
+    }
+    uint32_t *block = heap - HEADER_LIMBS;
+    LimbAllocator *allocator;
+    std::memcpy(&allocator, block, sizeof allocator);
+    if (allocator) {
+        allocator->deallocate(block, cap + HEADER_LIMBS);
+    } else {
+        ::operator delete(block);
+    }
+}
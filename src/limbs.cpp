@@ -0,0 +1,566 @@
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "../include/limbs.hpp"
+
+namespace limbs {
+
+MulThresholds &mul_thresholds() {
+    static MulThresholds thresholds;
+    return thresholds;
+}
+
+namespace {
+
+#if defined(__x86_64__)
+
+// Scalar kernels: two limbs at a time through the 64-bit ADC/SBB instructions
+limb_t add_n_adc(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t carry) {
+    unsigned char c = static_cast<unsigned char>(carry);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        unsigned long long x, y, sum;
+        std::memcpy(&x, a + i, sizeof x);
+        std::memcpy(&y, b + i, sizeof y);
+        c = _addcarry_u64(c, x, y, &sum);
+        std::memcpy(r + i, &sum, sizeof sum);
+    }
+    for (; i < n; i++) {
+        unsigned int sum;
+        c = _addcarry_u32(c, a[i], b[i], &sum);
+        r[i] = sum;
+    }
+    return c;
+}
+
+limb_t sub_n_sbb(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t borrow) {
+    unsigned char c = static_cast<unsigned char>(borrow);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        unsigned long long x, y, diff;
+        std::memcpy(&x, a + i, sizeof x);
+        std::memcpy(&y, b + i, sizeof y);
+        c = _subborrow_u64(c, x, y, &diff);
+        std::memcpy(r + i, &diff, sizeof diff);
+    }
+    for (; i < n; i++) {
+        unsigned int diff;
+        c = _subborrow_u32(c, a[i], b[i], &diff);
+        r[i] = diff;
+    }
+    return c;
+}
+
+// Carry-lookahead over eight lanes at a time. Each lane adds without carries, then
+// two bit masks are collected: G (the lane generates a carry) and P (the lane sum is
+// all ones, so it passes an incoming carry on). Adding (G << 1) + P + carry_in
+// ripples the carries through the mask in one scalar addition: the lanes receiving
+// a carry are the bits of that sum xor P, and bit 8 is the carry out of the block.
+__attribute__((target("avx2")))
+limb_t add_n_avx2(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t carry) {
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+    unsigned c = carry;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i sum = _mm256_add_epi32(x, y);
+
+        // Unsigned sum < x means the lane wrapped around
+        __m256i gen = _mm256_cmpgt_epi32(_mm256_xor_si256(x, sign), _mm256_xor_si256(sum, sign));
+        __m256i prop = _mm256_cmpeq_epi32(sum, ones);
+        unsigned g = _mm256_movemask_ps(_mm256_castsi256_ps(gen));
+        unsigned p = _mm256_movemask_ps(_mm256_castsi256_ps(prop));
+
+        unsigned ripple = (g << 1) + p + c;
+        unsigned carries = (ripple ^ p) & 0xFF;
+        c = ripple >> 8;
+
+        // Lanes receiving a carry become -1, subtracting them adds the carry
+        __m256i in = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(carries), lane_bits), lane_bits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), _mm256_sub_epi32(sum, in));
+    }
+    return add_n_adc(r + i, a + i, b + i, n - i, c);
+}
+
+// Same scheme for borrows: a lane generates one when a < b and passes one on when
+// its difference is zero
+__attribute__((target("avx2")))
+limb_t sub_n_avx2(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t borrow) {
+    const __m256i sign = _mm256_set1_epi32(INT32_MIN);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+
+    unsigned c = borrow;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i diff = _mm256_sub_epi32(x, y);
+
+        __m256i gen = _mm256_cmpgt_epi32(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign));
+        __m256i prop = _mm256_cmpeq_epi32(diff, zero);
+        unsigned g = _mm256_movemask_ps(_mm256_castsi256_ps(gen));
+        unsigned p = _mm256_movemask_ps(_mm256_castsi256_ps(prop));
+
+        unsigned ripple = (g << 1) + p + c;
+        unsigned borrows = (ripple ^ p) & 0xFF;
+        c = ripple >> 8;
+
+        __m256i in = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(borrows), lane_bits), lane_bits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), _mm256_add_epi32(diff, in));
+    }
+    return sub_n_sbb(r + i, a + i, b + i, n - i, c);
+}
+
+bool has_avx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#else
+
+// Portable kernels for targets without the x86 intrinsics
+limb_t add_n_adc(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t carry) {
+    for (size_t i = 0; i < n; i++) {
+        limb_t sum;
+        limb_t c1 = __builtin_add_overflow(a[i], b[i], &sum);
+        limb_t c2 = __builtin_add_overflow(sum, carry, &r[i]);
+        carry = c1 | c2;
+    }
+    return carry;
+}
+
+limb_t sub_n_sbb(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t borrow) {
+    for (size_t i = 0; i < n; i++) {
+        limb_t diff;
+        limb_t b1 = __builtin_sub_overflow(a[i], b[i], &diff);
+        limb_t b2 = __builtin_sub_overflow(diff, borrow, &r[i]);
+        borrow = b1 | b2;
+    }
+    return borrow;
+}
+
+#endif
+
+}  // namespace
+
+AddThresholds &add_thresholds() {
+    static AddThresholds thresholds;
+    return thresholds;
+}
+
+limb_t add_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t carry) {
+#if defined(__x86_64__)
+    if (n >= add_thresholds().simd && has_avx2()) return add_n_avx2(r, a, b, n, carry);
+#endif
+    return add_n_adc(r, a, b, n, carry);
+}
+
+limb_t sub_n(limb_t *r, const limb_t *a, const limb_t *b, size_t n, limb_t borrow) {
+#if defined(__x86_64__)
+    if (n >= add_thresholds().simd && has_avx2()) return sub_n_avx2(r, a, b, n, borrow);
+#endif
+    return sub_n_sbb(r, a, b, n, borrow);
+}
+
+limb_t add(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, limb_t carry) {
+    carry = add_n(r, a, b, bn, carry);
+    for (size_t i = bn; i < an; i++) {
+        r[i] = a[i] + carry;
+        carry = carry && r[i] == 0;
+    }
+    return carry;
+}
+
+limb_t sub(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn, limb_t borrow) {
+    borrow = sub_n(r, a, b, bn, borrow);
+    for (size_t i = bn; i < an; i++) {
+        limb_t cur = a[i];
+        r[i] = cur - borrow;
+        borrow = borrow && cur == 0;
+    }
+    return borrow;
+}
+
+limb_t neg_n(limb_t *r, const limb_t *a, size_t n) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        limb_t cur = a[i];
+        r[i] = 0 - cur - borrow;
+        borrow = borrow || cur != 0;
+    }
+    return borrow;
+}
+
+int cmp(const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    an = normalized_size(a, an);
+    bn = normalized_size(b, bn);
+    if (an != bn) return an < bn ? -1 : 1;
+    for (size_t i = an; i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+size_t normalized_size(const limb_t *a, size_t n) {
+    while (n > 0 && a[n - 1] == 0) n--;
+    return n;
+}
+
+limb_t lshift(limb_t *r, const limb_t *a, size_t n, unsigned shift) {
+    if (shift == 0) {
+        std::copy(a, a + n, r);
+        return 0;
+    }
+    limb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        limb_t cur = a[i];
+        r[i] = (cur << shift) | carry;
+        carry = cur >> (LIMB_BITS - shift);
+    }
+    return carry;
+}
+
+void rshift(limb_t *r, const limb_t *a, size_t n, unsigned shift) {
+    if (shift == 0) {
+        std::copy(a, a + n, r);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        limb_t next = i + 1 < n ? a[i + 1] : 0;
+        r[i] = (a[i] >> shift) | (next << (LIMB_BITS - shift));
+    }
+}
+
+limb_t mul_1(limb_t *r, const limb_t *a, size_t n, limb_t b, limb_t carry) {
+    dlimb_t cur = carry;
+    for (size_t i = 0; i < n; i++) {
+        cur += static_cast<dlimb_t>(a[i]) * b;
+        r[i] = static_cast<limb_t>(cur);
+        cur >>= LIMB_BITS;
+    }
+    return static_cast<limb_t>(cur);
+}
+
+limb_t divmod_1(limb_t *q, const limb_t *a, size_t n, limb_t d, limb_t rem) {
+    dlimb_t cur_rem = rem;
+    for (size_t i = n; i-- > 0;) {
+        dlimb_t cur = (cur_rem << LIMB_BITS) | a[i];
+        q[i] = static_cast<limb_t>(cur / d);
+        cur_rem = cur % d;
+    }
+    return static_cast<limb_t>(cur_rem);
+}
+
+limb_t mod_1(const limb_t *a, size_t n, limb_t d) {
+    dlimb_t rem = 0;
+    for (size_t i = n; i-- > 0;) {
+        rem = ((rem << LIMB_BITS) | a[i]) % d;
+    }
+    return static_cast<limb_t>(rem);
+}
+
+namespace {
+
+// Adds x[0 .. xn) into r[off .. rn) and propagates the carry. The caller guarantees
+// that the sum fits, so the carry never runs off the end of r
+void add_at(limb_t *r, size_t rn, size_t off, const limb_t *x, size_t xn) {
+    xn = normalized_size(x, xn);
+    if (xn == 0) return;
+    add(r + off, r + off, rn - off, x, xn);
+}
+
+// Signed intermediate value of the Toom-3 evaluation and interpolation
+struct Signed {
+    std::vector<limb_t> mag;
+    bool neg = false;
+
+    Signed() = default;
+
+    Signed(const limb_t *a, size_t n) : mag(a, a + normalized_size(a, n)) {}
+
+    void trim() {
+        mag.resize(normalized_size(mag.data(), mag.size()));
+        if (mag.empty()) neg = false;
+    }
+};
+
+Signed add_signed(const Signed &x, const Signed &y, bool negate_y = false) {
+    bool y_neg = y.neg ^ negate_y;
+    const Signed &big = x.mag.size() >= y.mag.size() ? x : y;
+    const Signed &small = x.mag.size() >= y.mag.size() ? y : x;
+
+    Signed res;
+    if (x.neg == y_neg) {
+        res.mag.resize(big.mag.size() + 1);
+        res.mag.back() = add(res.mag.data(), big.mag.data(), big.mag.size(), small.mag.data(), small.mag.size());
+        res.neg = x.neg;
+    } else {
+        bool x_bigger = cmp(x.mag.data(), x.mag.size(), y.mag.data(), y.mag.size()) >= 0;
+        const std::vector<limb_t> &hi = x_bigger ? x.mag : y.mag;
+        const std::vector<limb_t> &lo = x_bigger ? y.mag : x.mag;
+        res.mag.resize(hi.size());
+        sub(res.mag.data(), hi.data(), hi.size(), lo.data(), lo.size());
+        res.neg = x_bigger ? x.neg : y_neg;
+    }
+    res.trim();
+    return res;
+}
+
+Signed mul_signed(const Signed &x, const Signed &y) {
+    Signed res;
+    if (x.mag.empty() || y.mag.empty()) return res;
+    res.mag.resize(x.mag.size() + y.mag.size());
+    mul(res.mag.data(), x.mag.data(), x.mag.size(), y.mag.data(), y.mag.size());
+    res.neg = x.neg ^ y.neg;
+    res.trim();
+    return res;
+}
+
+Signed sqr_signed(const Signed &x) {
+    Signed res;
+    if (x.mag.empty()) return res;
+    res.mag.resize(2 * x.mag.size());
+    sqr(res.mag.data(), x.mag.data(), x.mag.size());
+    res.trim();
+    return res;
+}
+
+// x * 2
+Signed twice(const Signed &x) {
+    Signed res = x;
+    res.mag.push_back(0);
+    for (size_t i = res.mag.size() - 1; i > 0; i--) {
+        res.mag[i] = (res.mag[i] << 1) | (res.mag[i - 1] >> (LIMB_BITS - 1));
+    }
+    res.mag[0] <<= 1;
+    res.trim();
+    return res;
+}
+
+// x / 2, the division must be exact
+Signed half(const Signed &x) {
+    Signed res = x;
+    for (size_t i = 0; i < res.mag.size(); i++) {
+        limb_t next = i + 1 < res.mag.size() ? res.mag[i + 1] : 0;
+        res.mag[i] = (res.mag[i] >> 1) | (next << (LIMB_BITS - 1));
+    }
+    res.trim();
+    return res;
+}
+
+// x / 3, the division must be exact
+Signed third(const Signed &x) {
+    Signed res = x;
+    divmod_1(res.mag.data(), res.mag.data(), res.mag.size(), 3);
+    res.trim();
+    return res;
+}
+
+// Piece i of the Toom-3 split of a[0 .. n) into k-limb chunks, may be empty
+Signed piece(const limb_t *a, size_t n, size_t k, size_t i) {
+    size_t from = std::min(n, i * k);
+    size_t to = std::min(n, (i + 1) * k);
+    return Signed(a + from, to - from);
+}
+
+// Values of the Toom-3 polynomial of a[0 .. n) split into k-limb pieces at the
+// evaluation points 0, 1, -1, -2 and infinity
+struct Toom3Points {
+    Signed at0, at1, at_m1, at_m2, at_inf;
+};
+
+Toom3Points toom3_evaluate(const limb_t *a, size_t n, size_t k) {
+    Signed a0 = piece(a, n, k, 0), a1 = piece(a, n, k, 1), a2 = piece(a, n, k, 2);
+    Signed am = add_signed(a0, a2);
+    Signed a_p1 = add_signed(am, a1);
+    Signed a_m1 = add_signed(am, a1, true);
+    Signed a_m2 = add_signed(twice(add_signed(a_m1, a2)), a0, true);
+    return {a0, a_p1, a_m1, a_m2, a2};
+}
+
+// Bodrato's interpolation from the pointwise products and recomposition into r[0 .. rn)
+void toom3_interpolate(limb_t *r, size_t rn, size_t k, const Toom3Points &p) {
+    const Signed &r0 = p.at0, &r_p1 = p.at1, &r_m1 = p.at_m1, &r_m2 = p.at_m2, &r4 = p.at_inf;
+
+    Signed r3 = third(add_signed(r_m2, r_p1, true));
+    Signed r1 = half(add_signed(r_p1, r_m1, true));
+    Signed r2 = add_signed(r_m1, r0, true);
+    r3 = add_signed(half(add_signed(r2, r3, true)), twice(r4));
+    r2 = add_signed(add_signed(r2, r1), r4, true);
+    r1 = add_signed(r1, r3, true);
+
+    // Every coefficient of the product polynomial is non-negative
+    std::fill(r, r + rn, 0);
+    const Signed *coeffs[] = {&r0, &r1, &r2, &r3, &r4};
+    for (size_t i = 0; i < 5; i++) {
+        add_at(r, rn, i * k, coeffs[i]->mag.data(), coeffs[i]->mag.size());
+    }
+}
+
+// Cuts the longer operand into slices as long as the shorter one and accumulates
+// the partial products, so the shorter operand is never padded
+void mul_unbalanced(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    std::fill(r, r + an + bn, 0);
+    std::vector<limb_t> part(2 * bn);
+
+    for (size_t off = 0; off < an; off += bn) {
+        size_t len = std::min(bn, an - off);
+        mul(part.data(), a + off, len, b, bn);
+        add_at(r, an + bn, off, part.data(), len + bn);
+    }
+}
+
+} // namespace
+
+// Karatsuba: a = a1 * B^h + a0, b = b1 * B^h + b0,
+// a * b = z2 * B^2h + ((a0 + a1)(b0 + b1) - z2 - z0) * B^h + z0
+void mul_karatsuba(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    size_t h = (an + 1) / 2;
+    size_t a1n = an - h;
+    size_t b1n = bn - h;
+
+    // z0 and z2 land directly in their final places of r
+    mul(r, a, h, b, h);
+    mul(r + 2 * h, a + h, a1n, b + h, b1n);
+
+    std::vector<limb_t> sa(h + 1), sb(h + 1), mid(2 * h + 2);
+    sa[h] = add(sa.data(), a, h, a + h, a1n);
+    sb[h] = add(sb.data(), b, h, b + h, b1n);
+    mul(mid.data(), sa.data(), h + 1, sb.data(), h + 1);
+
+    sub(mid.data(), mid.data(), mid.size(), r, 2 * h);
+    sub(mid.data(), mid.data(), mid.size(), r + 2 * h, a1n + b1n);
+
+    add_at(r, an + bn, h, mid.data(), std::min(mid.size(), an + bn - h));
+}
+
+// Karatsuba squaring: the same split with a single operand, three half-size squares
+void sqr_karatsuba(limb_t *r, const limb_t *a, size_t n) {
+    size_t h = (n + 1) / 2;
+    size_t a1n = n - h;
+
+    sqr(r, a, h);
+    sqr(r + 2 * h, a + h, a1n);
+
+    std::vector<limb_t> sa(h + 1), mid(2 * h + 2);
+    sa[h] = add(sa.data(), a, h, a + h, a1n);
+    sqr(mid.data(), sa.data(), h + 1);
+
+    sub(mid.data(), mid.data(), mid.size(), r, 2 * h);
+    sub(mid.data(), mid.data(), mid.size(), r + 2 * h, 2 * a1n);
+
+    add_at(r, 2 * n, h, mid.data(), std::min(mid.size(), 2 * n - h));
+}
+
+// Toom-3 with evaluation points 0, 1, -1, -2, infinity and Bodrato's interpolation
+void mul_toom3(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    size_t k = (an + 2) / 3;
+
+    Toom3Points pa = toom3_evaluate(a, an, k);
+    Toom3Points pb = toom3_evaluate(b, bn, k);
+
+    Toom3Points products = {mul_signed(pa.at0, pb.at0), mul_signed(pa.at1, pb.at1), mul_signed(pa.at_m1, pb.at_m1),
+                            mul_signed(pa.at_m2, pb.at_m2), mul_signed(pa.at_inf, pb.at_inf)};
+    toom3_interpolate(r, an + bn, k, products);
+}
+
+// Toom-3 squaring: one evaluation and five pointwise squares
+void sqr_toom3(limb_t *r, const limb_t *a, size_t n) {
+    size_t k = (n + 2) / 3;
+
+    Toom3Points pa = toom3_evaluate(a, n, k);
+
+    Toom3Points squares = {sqr_signed(pa.at0), sqr_signed(pa.at1), sqr_signed(pa.at_m1), sqr_signed(pa.at_m2),
+                           sqr_signed(pa.at_inf)};
+    toom3_interpolate(r, 2 * n, k, squares);
+}
+
+void mul(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    if (a == b && an == bn) {
+        sqr(r, a, an);
+        return;
+    }
+
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+
+    // Low zero limbs only shift the product, high zero limbs contribute nothing
+    size_t a_low = 0, b_low = 0;
+    while (a_low < an && a[a_low] == 0) a_low++;
+    while (b_low < bn && b[b_low] == 0) b_low++;
+    size_t a_len = normalized_size(a + a_low, an - a_low);
+    size_t b_len = normalized_size(b + b_low, bn - b_low);
+
+    if (a_len == 0 || b_len == 0) {
+        std::fill(r, r + an + bn, 0);
+        return;
+    }
+
+    size_t shift = a_low + b_low;
+    std::fill(r, r + shift, 0);
+    std::fill(r + shift + a_len + b_len, r + an + bn, 0);
+    r += shift;
+    a += a_low;
+    b += b_low;
+
+    if (a_len < b_len) {
+        std::swap(a, b);
+        std::swap(a_len, b_len);
+    }
+
+    const MulThresholds &thr = mul_thresholds();
+    if (b_len < std::max<size_t>(thr.karatsuba, 4)) {
+        mul_basecase(r, a, a_len, b, b_len);
+    } else if (2 * b_len <= a_len + 1) {
+        mul_unbalanced(r, a, a_len, b, b_len);
+    } else if (b_len < thr.toom3) {
+        mul_karatsuba(r, a, a_len, b, b_len);
+    } else if (b_len < thr.ntt) {
+        mul_toom3(r, a, a_len, b, b_len);
+    } else {
+        mul_ntt(r, a, a_len, b, b_len);
+    }
+}
+
+void sqr(limb_t *r, const limb_t *a, size_t n) {
+    // Low zero limbs shift the square by twice their count, high zero limbs add nothing
+    size_t low = 0;
+    while (low < n && a[low] == 0) low++;
+    size_t len = normalized_size(a + low, n - low);
+
+    if (len == 0) {
+        std::fill(r, r + 2 * n, 0);
+        return;
+    }
+
+    std::fill(r, r + 2 * low, 0);
+    std::fill(r + 2 * (low + len), r + 2 * n, 0);
+    r += 2 * low;
+    a += low;
+
+    const MulThresholds &thr = mul_thresholds();
+    if (len < std::max<size_t>(thr.sqr_karatsuba, 4)) {
+        sqr_basecase(r, a, len);
+    } else if (len < thr.toom3) {
+        sqr_karatsuba(r, a, len);
+    } else if (len < thr.ntt) {
+        sqr_toom3(r, a, len);
+    } else {
+        mul_ntt(r, a, len, a, len);
+    }
+}
+
+} // namespace limbs
@@ -1,288 +1,243 @@
 #include <iostream>
+#include <ostream>
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
 #include <chrono>
 
 #include "../include/long_arithmetic.hpp"
+#include "../include/limbs.hpp"
 
 // Constructor: Converts a decimal string to binary representation with specified fractional bits
 FixedPoint::FixedPoint(const std::string &num_str, int frac_bits) : fractional_bits(frac_bits) {
     auto binary_result = decimal_to_binary(num_str, fractional_bits);
 
-    integer = binary_result.first;     // Store the integer part in binary
-    fractional = binary_result.second; // Store the fractional part in binary
+    frac_limbs = binary_result.second.size();
+    limb.resize(frac_limbs + binary_result.first.size());
+    std::copy(binary_result.second.begin(), binary_result.second.end(), limb.begin());
+    std::copy(binary_result.first.begin(), binary_result.first.end(), limb.begin() + frac_limbs);
     is_negative = num_str[0] == '-';
 }
 
-FixedPoint::FixedPoint(const double &num, int frac_bits) : fractional_bits(frac_bits) {
-    auto binary_result = decimal_to_binary(std::to_string(num), fractional_bits);
+FixedPoint::FixedPoint(const double &num, int frac_bits) : fractional_bits(frac_bits), is_negative(num < 0) {
+    if (!std::isfinite(num)) {
+        throw std::runtime_error("Cannot convert an infinite or NaN double");
+    }
 
-    integer = binary_result.first;     // Store the integer part in binary
-    fractional = binary_result.second; // Store the fractional part in binary
-    is_negative = num < 0;
-}
+    // num = mantissa * 2^exponent with an integer mantissa of at most 53 bits
+    int exponent = 0;
+    uint64_t mantissa = static_cast<uint64_t>(std::ldexp(std::fabs(std::frexp(num, &exponent)), 53));
+    exponent -= 53;
 
+    // Bit position of the mantissa inside the magnitude, whose lowest frac_sz limbs
+    // hold the fraction
+    size_t frac_sz = frac_bits > 0 ? (frac_bits + 31) / 32 : 0;
+    long long pos = exponent + 32 * static_cast<long long>(frac_sz);
+    if (pos < 0) {
+        mantissa = -pos < 64 ? mantissa >> -pos : 0;
+        pos = 0;
+    }
 
-// Default copy constructor and destructor
-FixedPoint::FixedPoint(const FixedPoint& other) = default;
-FixedPoint::~FixedPoint() = default;
+    // 53 bits shifted by less than a limb span at most three limbs of the magnitude
+    size_t index = pos / 32;
+    unsigned shift = pos % 32;
+    frac_limbs = frac_sz;
+    limb.assign(std::max<size_t>(frac_sz + 1, index + 3), 0);
+    uint64_t low = mantissa << shift;
+    limb[index] = static_cast<uint32_t>(low);
+    limb[index + 1] = static_cast<uint32_t>(low >> 32);
+    limb[index + 2] = static_cast<uint32_t>(shift ? mantissa >> (64 - shift) : 0);
 
-// Default assignment operator
-FixedPoint& FixedPoint::operator=(const FixedPoint& other) = default;
-
-// Overload the + operator for adding two FixedPoint numbers
-FixedPoint FixedPoint::operator+(const FixedPoint &other) const {
+    // Bits past frac_bits are dropped like in the string constructor
+    if (frac_sz != 0) {
+        limb[0] &= 0xFFFFFFFFu << (32 * frac_sz - frac_bits);
+    }
 
-    Op_behavior behavior = helper(*this, other, '+');
+    trim_integer();
 
-    // Create a result object with the maximum fractional bits between the two operands
-    FixedPoint result("0.0", std::max(fractional_bits, other.fractional_bits));
+    // Negative numbers truncated to nothing give an unsigned zero like the arithmetic
+    if (is_zero()) {
+        is_negative = false;
+    }
+}
 
-    switch (behavior) {
-        case Op_behavior::PLUS_FST: {
-            bool res_compare = !less_abs(*this, other);
-            const FixedPoint &a = (res_compare ? *this : other);
-            const FixedPoint &b = (res_compare ? other : *this);
+FixedPoint::FixedPoint(int64_t num, int frac_bits)
+    : FixedPoint(num < 0 ? 0 - static_cast<uint64_t>(num) : static_cast<uint64_t>(num), frac_bits) {
+    is_negative = num < 0;
+}
 
-            auto sub_res = subtract_nums(a, b);
+FixedPoint::FixedPoint(uint64_t num, int frac_bits) : fractional_bits(frac_bits), is_negative(false) {
+    frac_limbs = frac_bits > 0 ? (frac_bits + 31) / 32 : 0;
+    limb.assign(frac_limbs, 0);
+    limb.push_back(static_cast<uint32_t>(num));
+    if (num >> 32) {
+        limb.push_back(static_cast<uint32_t>(num >> 32));
+    }
+}
 
-            result.integer = sub_res.first;     // Assign the computed integer part to the result
-            result.fractional = sub_res.second; // Assign the computed fractional part to the result
-            result.is_negative = a.is_negative;
-            break;
-        }
-        case Op_behavior::PLUS_SND: {
+// Builds a value from an already computed magnitude and brings it to the canonical form
+FixedPoint::FixedPoint(LimbVector &&mag, size_t frac_sz, bool negative)
+    : limb(std::move(mag)), frac_limbs(frac_sz), fractional_bits(0), is_negative(negative) {
+    normalize();
+}
 
-            // Add fractional parts and handle carry
-            auto add_res = add_frac(fractional, other.fractional);
-            result.fractional = add_res.first;
+// Default copy constructor and destructor
+FixedPoint::FixedPoint(const FixedPoint& other) = default;
+FixedPoint::~FixedPoint() = default;
 
-            // Add integer parts and handle carry from fractional addition
-            add_res = add_int(integer, other.integer, add_res.second);
-            result.integer = add_res.first;
+// Default assignment operator
+FixedPoint& FixedPoint::operator=(const FixedPoint& other) = default;
 
-            // If there's still a carry, append it to the integer part
-            if (add_res.second) {
-                result.integer.push_back(1);
-            }
-            result.is_negative = is_negative;
-            break;
-        }
-        default:
-            throw std::invalid_argument("Unexpected behavior encountered");
-    }
+// Move constructor and move assignment only steal the limb buffers
+FixedPoint::FixedPoint(FixedPoint&& other) noexcept = default;
+FixedPoint& FixedPoint::operator=(FixedPoint&& other) noexcept = default;
 
-    while (result.fractional.size() > 1 && result.fractional.front() == 0) {
-        result.fractional.erase(result.fractional.begin());
-    }
-    while (result.integer.size() > 1 && result.integer.back() == 0) {
-        result.integer.erase(result.integer.end() - 1);
-    }
-    result.fractional_bits = result.fractional.size() * 32;
+// Overload the + operator for adding two FixedPoint numbers
+FixedPoint FixedPoint::operator+(const FixedPoint &other) const & {
+    FixedPoint result = *this;
+    result += other;
+    return result;
+}
 
+// A temporary left operand is reused as the result
+FixedPoint FixedPoint::operator+(const FixedPoint &other) && {
+    FixedPoint result = std::move(*this);
+    result += other;
     return result;
 }
 
 // Overload the - operator for subtracting two FixedPoint numbers
-FixedPoint FixedPoint::operator-(const FixedPoint &other) const {
-
-    Op_behavior behavior = helper(*this, other, '-');
-    // Create a result object with the maximum fractional bits between the two operands
-    FixedPoint result("0.0", std::max(fractional_bits, other.fractional_bits));
-
-    switch (behavior) {
-        case Op_behavior::SUB_FST: {
-            // Add fractional parts and handle carry
-            auto add_res = add_frac(fractional, other.fractional);
-            result.fractional = add_res.first;
-
-            // Add integer parts and handle carry from fractional addition
-            add_res = add_int(integer, other.integer, add_res.second);
-            result.integer = add_res.first;
-
-            // If there's still a carry, append it to the integer part
-            if (add_res.second) {
-                result.integer.push_back(1);
-            }
-            result.is_negative = is_negative;
-            break;
-        }
-        case Op_behavior::SUB_SND: {
-            bool res_compare = !less_abs(*this, other);
-            const FixedPoint &a = (res_compare ? *this : other);
-            const FixedPoint &b = (res_compare ? other : *this);
-
-            auto sub_res = subtract_nums(a, b);
-
-            result.integer = sub_res.first;     // Assign the computed integer part to the result
-            result.fractional = sub_res.second; // Assign the computed fractional part to the result
-            result.is_negative = (is_negative ? res_compare : !res_compare);
-
-            break;
-        }
-        default:
-            throw std::invalid_argument("Unexpected behavior encountered");
-    }
-
-    while (result.fractional.size() > 1 && result.fractional.front() == 0) {
-        result.fractional.erase(result.fractional.begin());
-    }
-    while (result.integer.size() > 1 && result.integer.back() == 0) {
-        result.integer.erase(result.integer.end() - 1);
-    }
-    result.fractional_bits = result.fractional.size() * 32;
+FixedPoint FixedPoint::operator-(const FixedPoint &other) const & {
+    FixedPoint result = *this;
+    result -= other;
+    return result;
+}
 
+FixedPoint FixedPoint::operator-(const FixedPoint &other) && {
+    FixedPoint result = std::move(*this);
+    result -= other;
     return result;
 }
 
 // Overload the * operator for multiplying two FixedPoint numbers
 FixedPoint FixedPoint::operator*(const FixedPoint &other) const {
-    // Create a result object with sufficient fractional bits for multiplication
-    FixedPoint result("0.0", (fractional_bits / 32 + 1) * 32 + (other.fractional_bits / 32 +  1) * 32);
-
-    // Compute the sizes of the operands
-    uint32_t this_sz = integer.size() + fractional.size();
-    uint32_t other_sz = other.integer.size() + other.fractional.size();
-
-    // Allocate space for intermediate multiplication results
-    uint32_t mid_mult_sz = (this_sz + other_sz) * 32 + 1;
-    std::vector<uint32_t> mid_mult(mid_mult_sz);
-
-    // Perform bitwise multiplication
-    for (uint32_t this_i = 0; this_i < this_sz; this_i++) {
-        for (uint32_t bit_this = 0; bit_this < 32; bit_this++) {
-            for (uint32_t other_i = 0; other_i < other_sz; other_i++) {
-                for (uint32_t bit_other = 0; bit_other < 32; bit_other++) {
-                    if (this_i < fractional.size() && other_i < other.fractional.size()) {
-                        mid_mult[32 * (this_i + other_i) + bit_this + bit_other] +=
-                        (fractional[this_i] >> bit_this) & (other.fractional[other_i] >> bit_other) & 0x00000001;
-                    }
-                    if (this_i < fractional.size() && other_i >= other.fractional.size()) {
-                        mid_mult[32 * (this_i + other_i) + bit_this + bit_other] +=
-                        (fractional[this_i] >> bit_this) & (other.integer[other_i - other.fractional.size()] >> bit_other) & 0x00000001;
-                    }
-                    if (this_i >= fractional.size() && other_i < other.fractional.size()) {
-                        mid_mult[32 * (this_i + other_i) + bit_this + bit_other] +=
-                        (integer[this_i - fractional.size()] >> bit_this) & (other.fractional[other_i] >> bit_other) & 0x00000001;
-                    }
-                    if (this_i >= fractional.size() && other_i >= other.fractional.size()) {
-                        mid_mult[32 * (this_i + other_i) + bit_this + bit_other] +=
-                        (integer[this_i - fractional.size()] >> bit_this) & (other.integer[other_i - other.fractional.size()] >> bit_other) & 0x00000001;
-                    }
-                }
-            }
-        }
-    }
-
-    // Convert the intermediate multiplication result into integer and fractional parts
-    std::vector<uint32_t> mult_int_result;
-    std::vector<uint32_t> mult_frac_result;
-    int bit_added = 0;
-
-    for (size_t i = 0; i < mid_mult_sz - 1; i++) {
-        if (i < 32 * (fractional.size() + other.fractional.size())) {
-            if (bit_added == 0) mult_frac_result.push_back(0);
-            mult_frac_result.back() = mult_frac_result.back() | ((mid_mult[i] % 2) << bit_added);
-            mid_mult[i + 1] += mid_mult[i] / 2;
-            bit_added = (bit_added + 1) % 32;
-        } else {
-            if (bit_added == 0) mult_int_result.push_back(0);
-            mult_int_result.back() = mult_int_result.back() | ((mid_mult[i] % 2) << bit_added);
-            mid_mult[i + 1] += mid_mult[i] / 2;
-            bit_added = (bit_added + 1) % 32;
-        }
-    }
-
-    result.integer = mult_int_result;     // Assign the computed integer part to the result
-    result.fractional = mult_frac_result; // Assign the computed fractional part to the result
-    result.is_negative = is_negative ^ other.is_negative;
-
-    while (result.fractional.size() > 1 && result.fractional.front() == 0) {
-        result.fractional.erase(result.fractional.begin());
-    }
-    while (result.integer.size() > 1 && result.integer.back() == 0) {
-        result.integer.erase(result.integer.end() - 1);
-    }
-    result.fractional_bits = result.fractional.size() * 32;
-
-    return result;
+    // The radix point of the product lies after the fractional limbs of both operands
+    return FixedPoint(multiply(other), frac_limbs + other.frac_limbs, is_negative ^ other.is_negative);
 }
 
 // Overload the / operator
 FixedPoint FixedPoint::operator/(const FixedPoint &other) const {
-    // Create a result object with sufficient fractional bits for division
-    FixedPoint result("0.0", std::max(fractional_bits, other.fractional_bits));
+    // Long divisors go through a Newton reciprocal, which costs a few multiplications
+    if (use_reciprocal(other)) {
+        return *this / Reciprocal(other);
+    }
 
-    auto div_res = divide(*this, other);
+    return FixedPoint(divide(*this, other), frac_limbs + other.frac_limbs, is_negative ^ other.is_negative);
+}
 
-    result.integer.clear();
-    result.fractional.clear();
+FixedPoint FixedPoint::operator/(const Reciprocal &other) const {
+    return FixedPoint(divide(*this, other), frac_limbs + other.frac_limbs, is_negative ^ other.is_negative);
+}
 
-    result.integer = div_res.first;
-    result.fractional = div_res.second;
+FixedPoint::Reciprocal::Reciprocal(const FixedPoint &divisor)
+    : inverse(divisor.limb.data(), divisor.limb.size()),
+      frac_limbs(divisor.frac_limbs),
+      is_negative(divisor.is_negative) {}
 
-    if (result.integer.empty()) result.integer.push_back(0);
-    if (result.fractional.empty()) result.fractional.push_back(0);
+FixedPoint FixedPoint::operator<<(size_t bits) const {
+    FixedPoint result = *this;
+    result <<= bits;
+    return result;
+}
 
-    result.is_negative = is_negative ^ other.is_negative;
+FixedPoint FixedPoint::operator>>(size_t bits) const {
+    FixedPoint result = *this;
+    result >>= bits;
+    return result;
+}
 
-    while (result.fractional.size() > 1 && result.fractional.front() == 0) {
-        result.fractional.erase(result.fractional.begin());
+uint32_t FixedPoint::remainder_word(uint32_t other) const {
+    if (other == 0) {
+        throw std::runtime_error("Attempted division by zero");
     }
-    while (result.integer.size() > 1 && result.integer.back() == 0) {
-        result.integer.erase(result.integer.end() - 1);
+    return limbs::mod_1(int_data(), int_limbs(), other);
+}
+
+FixedPoint FixedPoint::linear_combination(const Term *terms, size_t count) {
+    // The accumulator holds the widest fraction and integer part of all terms plus one
+    // limb for the carries and the sign, in two's complement
+    size_t frac_sz = 0, int_sz = 0, scaled_sz = 0;
+    for (size_t i = 0; i < count; i++) {
+        const FixedPoint &value = *terms[i].value;
+        if (terms[i].div == 0) {
+            throw std::runtime_error("Attempted division by zero");
+        }
+        bool scaled = terms[i].mul != 1 || terms[i].div != 1;
+        frac_sz = std::max(frac_sz, value.frac_limbs);
+        int_sz = std::max(int_sz, value.int_limbs() + (terms[i].mul != 1));
+        if (scaled) {
+            scaled_sz = std::max(scaled_sz, value.limb.size() + 1);
+        }
+    }
+    LimbVector acc(frac_sz + int_sz + 1);
+    LimbVector scratch(scaled_sz);
+
+    for (size_t i = 0; i < count; i++) {
+        const Term &term = terms[i];
+        const FixedPoint &value = *term.value;
+        size_t n = value.limb.size();
+        const uint32_t *src = value.limb.data();
+
+        // Scaled terms go through the scratch magnitude, the division first like value / div * mul
+        if (term.mul != 1 || term.div != 1) {
+            limbs::divmod_1(scratch.data(), src, n, term.div);
+            scratch[n] = limbs::mul_1(scratch.data(), scratch.data(), n, term.mul);
+            src = scratch.data();
+            n += 1;
+        }
+
+        // Aligned at the radix point; carries and borrows stop as soon as they are absorbed
+        uint32_t *dst = acc.data() + frac_sz - value.frac_limbs;
+        size_t rest = acc.data() + acc.size() - dst;
+        if (value.is_negative != term.negative) {
+            uint32_t borrow = limbs::sub_n(dst, dst, src, n);
+            for (size_t j = n; borrow && j < rest; j++) {
+                borrow = dst[j]-- == 0;
+            }
+        } else {
+            uint32_t carry = limbs::add_n(dst, dst, src, n);
+            for (size_t j = n; carry && j < rest; j++) {
+                carry = ++dst[j] == 0;
+            }
+        }
     }
 
-    result.fractional_bits = result.fractional.size() * 32;
-
-    return result;
+    // A set top bit means a negative sum: -x = ~x + 1
+    bool negative = acc.back() >> 31;
+    if (negative) {
+        limbs::neg_n(acc.data(), acc.data(), acc.size());
+    }
+    return FixedPoint(std::move(acc), frac_sz, negative);
 }
 
 // Overload comparison operators for two FixedPoint numbers
 bool FixedPoint::operator>(const FixedPoint &other) const {
-    bool abs_compare = bigger_abs(*this, other);
+    bool abs_compare = compare_abs(*this, other) > 0;
     if (!is_negative && !other.is_negative) return abs_compare;
     if (is_negative && other.is_negative) return !abs_compare;
     return !is_negative;
 }
 
 bool FixedPoint::operator<(const FixedPoint &other) const {
-    bool abs_compare = less_abs(*this, other);
+    bool abs_compare = compare_abs(*this, other) < 0;
     if (!is_negative && !other.is_negative) return abs_compare;
     if (is_negative && other.is_negative) return !abs_compare;
     return is_negative;
 }
 
 bool FixedPoint::operator==(const FixedPoint &other) const {
-    for (int i = std::max(integer.size(), other.integer.size()) - 1; i >= 0; i--) {
-        uint32_t val_a = ((uint32_t) i) < integer.size() ? integer[i] : 0;
-        uint32_t val_b = ((uint32_t) i) < other.integer.size() ? other.integer[i] : 0;
-        if (val_a != val_b) {
-            return false;
-        }
-    }
-
-    int this_i = fractional.size() - 1, other_i = other.fractional.size() - 1;
-    for (; this_i >= 0 && other_i >= 0; this_i--, other_i--) {
-
-        if (fractional[this_i] != other.fractional[other_i]) {
-            return false;
-        }
-    }
-
-    if (this_i == -1 && other_i == -1) return true;
-    if (this_i == -1) {
-        for (; other_i >= 0; other_i--) {
-            if (other.fractional[other_i] != 0) return false;
-        }
-    }
-    if (other_i == -1) {
-        for (; this_i >= 0; this_i--) {
-            if (fractional[this_i] != 0) return false;
-        }
-    }
-    return false;
+    return compare_abs(*this, other) == 0;
 }
 
 bool FixedPoint::operator<=(const FixedPoint &other) const {
@@ -297,35 +252,152 @@ bool FixedPoint::operator!=(const FixedPoint &other) const {
     return !(*this == other);
 }
 
+// Works on the limbs of *this in place, no new buffer unless the operand is longer
 FixedPoint& FixedPoint::operator+=(const FixedPoint &other) {
-    *this = *this + other;
+    switch (helper(*this, other, '+')) {
+        case Op_behavior::PLUS_FST:
+            // Different signs: the operand with the bigger magnitude gives the sign
+            if (sub_magnitude(other)) is_negative = other.is_negative;
+            break;
+        case Op_behavior::PLUS_SND:
+            add_magnitude(other);
+            break;
+        default:
+            throw std::invalid_argument("Unexpected behavior encountered");
+    }
+
+    normalize();
     return *this;
 }
 
+// The multiplication cannot write over its operands, so the product gets a buffer of
+// its own that replaces the old limbs
 FixedPoint& FixedPoint::operator*=(const FixedPoint &other) {
-    *this = *this * other;
+    limb = multiply(other);
+    frac_limbs += other.frac_limbs;
+    is_negative = is_negative ^ other.is_negative;
+
+    normalize();
     return *this;
 }
 
 FixedPoint& FixedPoint::operator-=(const FixedPoint &other) {
-    *this = *this - other;
+    switch (helper(*this, other, '-')) {
+        case Op_behavior::SUB_FST:
+            add_magnitude(other);
+            break;
+        case Op_behavior::SUB_SND:
+            // Same signs: the result flips sign when the subtrahend is bigger
+            if (sub_magnitude(other)) is_negative = !is_negative;
+            break;
+        default:
+            throw std::invalid_argument("Unexpected behavior encountered");
+    }
+
+    normalize();
     return *this;
 }
 
+// The quotient is moved into *this, nothing is copied
 FixedPoint& FixedPoint::operator/=(const FixedPoint &other) {
-    *this = *this / other;
+    limb = use_reciprocal(other) ? divide(*this, Reciprocal(other)) : divide(*this, other);
+    frac_limbs += other.frac_limbs;
+    is_negative = is_negative ^ other.is_negative;
+
+    normalize();
+    return *this;
+}
+
+FixedPoint& FixedPoint::multiply_word(uint32_t other) {
+    // One pass over the whole magnitude, the last carry becomes a new integer limb
+    uint32_t carry = limbs::mul_1(limb.data(), limb.data(), limb.size(), other);
+    if (carry) {
+        limb.push_back(carry);
+    }
+
+    normalize();
+    return *this;
+}
+
+FixedPoint& FixedPoint::divide_word(uint32_t other) {
+    if (other == 0) {
+        throw std::runtime_error("Attempted division by zero");
+    }
+
+    // One pass from the top limb down, the quotient keeps the radix point
+    limbs::divmod_1(limb.data(), limb.data(), limb.size(), other);
+
+    normalize();
+    return *this;
+}
+
+FixedPoint& FixedPoint::operator<<=(size_t bits) {
+    size_t shift_limbs = bits / 32;
+    unsigned shift = bits % 32;
+    size_t n = limb.size();
+
+    if (shift_limbs == 0) {
+        uint32_t carry = limbs::lshift(limb.data(), limb.data(), n, shift);
+        if (carry) {
+            limb.push_back(carry);
+        }
+    } else {
+        // The radix point stays, whole limbs enter as zeros below the shifted magnitude
+        LimbVector mag(shift_limbs + n + 1);
+        mag[shift_limbs + n] = limbs::lshift(mag.data() + shift_limbs, limb.data(), n, shift);
+        limb = std::move(mag);
+    }
+
+    normalize();
+    return *this;
+}
+
+FixedPoint& FixedPoint::operator>>=(size_t bits) {
+    size_t shift_limbs = bits / 32;
+    size_t n = limb.size();
+
+    // In place from the bottom up, limbs below the radix point of *this fall off
+    if (shift_limbs < n) {
+        limbs::rshift(limb.data(), limb.data() + shift_limbs, n - shift_limbs, bits % 32);
+        std::fill(limb.begin() + (n - shift_limbs), limb.end(), 0);
+    } else {
+        std::fill(limb.begin(), limb.end(), 0);
+    }
+
+    normalize();
     return *this;
 }
 
+FixedPoint ldexp(const FixedPoint &x, ptrdiff_t exp) {
+    ptrdiff_t shift_limbs = exp >= 0 ? exp / 32 : -((31 - exp) / 32);
+    unsigned shift = static_cast<unsigned>(exp - 32 * shift_limbs);
+
+    // Moving the radix point below the lowest limb adds zero limbs under the magnitude,
+    // moving it above the top one adds zero integer limbs
+    ptrdiff_t frac_sz = static_cast<ptrdiff_t>(x.frac_limbs) - shift_limbs;
+    size_t low = frac_sz < 0 ? static_cast<size_t>(-frac_sz) : 0;
+    frac_sz = std::max<ptrdiff_t>(frac_sz, 0);
+
+    size_t n = x.limb.size();
+    LimbVector mag(std::max(low + n + 1, static_cast<size_t>(frac_sz) + 1));
+    mag[low + n] = limbs::lshift(mag.data() + low, x.limb.data(), n, shift);
+    return FixedPoint(std::move(mag), frac_sz, x.is_negative);
+}
+
 // Reduces the precision of the fractional part by removing bits and updating the fractional representation
 void FixedPoint::set_precision(size_t precision) {
     if (precision > fractional_bits) {
-        std::cout << "You can just set less value" << std::endl;
+        size_t frac_sz = (precision + 31) / 32;
+        if (frac_sz > frac_limbs) {
+            widen_fraction(frac_sz);
+        }
+        fractional_bits = precision;
         return;
     }
 
     if (precision == 0) {
-        fractional.clear();
+        limb.erase(limb.begin(), limb.begin() + frac_limbs);
+        frac_limbs = 0;
         fractional_bits = 0;
         return;
     }
@@ -334,14 +406,17 @@ void FixedPoint::set_precision(size_t precision) {
     int low_order_bits = (fractional_bits % 32 ? fractional_bits % 32 : 32);
     if (need_to_del >= low_order_bits) {
         uint32_t q_del = (need_to_del - low_order_bits) / 32 + 1;
-        fractional.erase(fractional.begin(), fractional.begin() + q_del);
+        limb.erase(limb.begin(), limb.begin() + q_del);
+        frac_limbs -= q_del;
 
-        if (!fractional.empty())
-            fractional[0] &= 0xFFFFFFFF << ((need_to_del - low_order_bits) % 32);
-        else
-            fractional.push_back(0);
+        if (frac_limbs != 0) {
+            limb[0] &= 0xFFFFFFFF << ((need_to_del - low_order_bits) % 32);
+        } else {
+            limb.insert(limb.begin(), 1, 0);
+            frac_limbs = 1;
+        }
     } else {
-        fractional[0] &= 0xFFFFFFFF << need_to_del;
+        limb[0] &= 0xFFFFFFFF << need_to_del;
     }
     fractional_bits = precision;
 }
@@ -351,14 +426,16 @@ void FixedPoint::print_bin() const {
     std::cout << (is_negative ? "-" : "+") << std::endl;
     std::cout << "Fractional_bits: " << fractional_bits << std::endl;
     std::cout << "Integer bits:    ";
-    for (uint32_t value : integer) {
+    for (size_t i = frac_limbs; i < limb.size(); i++) {
+        uint32_t value = limb[i];
         printBits(value);
         std::cout << " ";
     }
     std::cout << std::endl;
 
     std::cout << "Fractional bits: ";
-    for (uint32_t value : fractional) {
+    for (size_t i = 0; i < frac_limbs; i++) {
+        uint32_t value = limb[i];
         printBits(value);
         std::cout << " ";
     }
@@ -366,41 +443,29 @@ void FixedPoint::print_bin() const {
 }
 
 std::string FixedPoint::to_string(int len) const {
-    FixedPoint ten = FixedPoint{"10"};
-
-    FixedPoint before = *this;
-
-    before.set_precision(0);
-
-    FixedPoint after = *this - before;
-
-    std::string before_res;
-    while (!before.is_zero()) {
-        FixedPoint cur = before / ten;
-        cur.set_precision(0);
-        FixedPoint rem = before - (cur * ten);
-        before_res.push_back('0' + rem.integer[0]);
-
-        before = cur;
-    }
+    std::string before_res = limbs::to_decimal(int_data(), int_limbs());
 
-    if (before_res == "") {
-        before_res = "0";
+    // Low zero limbs change neither the value nor the number of digits printed
+    size_t low_zeros = 0;
+    while (low_zeros + 1 < frac_limbs && limb[low_zeros] == 0) {
+        low_zeros++;
     }
+    const uint32_t *frac = limb.data() + low_zeros;
+    size_t frac_sz = frac_limbs - low_zeros;
 
-    std::reverse(before_res.begin(), before_res.end());
-
+    // Eight decimal digits per fractional limb: floor(frac * 10^digits / 2^(32 * frac_sz)),
+    // with trailing zeros dropped when the expansion terminates within those digits
     std::string after_res;
-    int stop = after.fractional_bits;
-    while (!after.is_zero() && stop > 0) {
-        FixedPoint cur = after * ten;
-        FixedPoint rem = after * ten;
-        rem.set_precision(0);
-
-        after_res.push_back('0' + rem.integer[0]);
+    if (limbs::normalized_size(frac, frac_sz) != 0) {
+        size_t digits = 8 * frac_sz;
+        std::vector<uint32_t> scale = limbs::pow_1(10, digits);
+        std::vector<uint32_t> scaled(frac_sz + scale.size());
+        limbs::mul(scaled.data(), frac, frac_sz, scale.data(), scale.size());
 
-        after = cur - rem;
-        stop -= 4;
+        after_res = limbs::to_decimal(scaled.data() + frac_sz, scale.size(), digits);
+        if (limbs::normalized_size(scaled.data(), frac_sz) == 0) {
+            after_res.erase(after_res.find_last_not_of('0') + 1);
+        }
     }
 
     if (after_res == "") {
@@ -420,15 +485,53 @@ std::string FixedPoint::to_string(int len) const {
     return before_res + "." + after_res;
 }
 
+void FixedPoint::write(std::ostream &out, size_t frac_digits, size_t chunk) const {
+    if (is_negative) {
+        out << '-';
+    }
+    limbs::write_decimal(out, int_data(), int_limbs(), 0, chunk);
+    out << '.';
+    if (frac_digits == 0) {
+        return;
+    }
+
+    // The digits are the integer part of frac * 10^frac_digits
+    size_t frac_sz = limbs::normalized_size(limb.data(), frac_limbs) != 0 ? frac_limbs : 0;
+    std::vector<uint32_t> scale = limbs::pow_1(10, frac_digits);
+    std::vector<uint32_t> scaled(frac_sz + scale.size(), 0);
+    if (frac_sz != 0) {
+        limbs::mul(scaled.data(), limb.data(), frac_sz, scale.data(), scale.size());
+    }
+    scale = std::vector<uint32_t>();
+
+    limbs::write_decimal(out, scaled.data() + frac_sz, scaled.size() - frac_sz, frac_digits, chunk);
+}
+
 bool FixedPoint::is_zero() const {
-    if (integer.size() == 0 && fractional.size() == 0) return true;
-    for (uint32_t val : integer) {
-        if (val != 0) return false;
+    return limbs::normalized_size(limb.data(), limb.size()) == 0;
+}
+
+// Trims zero limbs below the fractional part and above the integer part, keeping one
+// limb in each, and updates fractional_bits accordingly. Both ends are checked in O(1)
+// and a canonical value is left untouched; low zero limbs go in a single erase.
+void FixedPoint::normalize() {
+    size_t low_zeros = 0;
+    while (low_zeros + 1 < frac_limbs && limb[low_zeros] == 0) {
+        low_zeros++;
+    }
+    if (low_zeros != 0) {
+        limb.erase(limb.begin(), limb.begin() + low_zeros);
+        frac_limbs -= low_zeros;
     }
-    for (uint32_t val : fractional) {
-        if (val != 0) return false;
+
+    trim_integer();
+    fractional_bits = frac_limbs * 32;
+}
+
+void FixedPoint::trim_integer() {
+    while (int_limbs() > 1 && limb.back() == 0) {
+        limb.pop_back();
     }
-    return true;
 }
 
 Op_behavior FixedPoint::helper(const FixedPoint &a, const FixedPoint &b, char op) const {
@@ -455,388 +558,156 @@ void FixedPoint::printBits(uint32_t value) const {
     }
 }
 
-bool FixedPoint::bigger_abs(const FixedPoint &a, const FixedPoint &b) const {
-    for (int i = std::max(a.integer.size(), b.integer.size()) - 1; i >= 0; i--) {
-        uint32_t val_a = ((uint32_t) i) < a.integer.size() ? a.integer[i] : 0;
-        uint32_t val_b = ((uint32_t) i) < b.integer.size() ? b.integer[i] : 0;
-        if (val_a > val_b) {
-            return true;
-        }
-        if (val_a < val_b) {
-            return false;
-        }
-    }
-
-    int a_i = a.fractional.size() - 1, b_i = b.fractional.size() - 1;
-    for (; a_i >= 0 && b_i >= 0; a_i--, b_i--) {
-        if (a.fractional[a_i] > b.fractional[b_i]) {
-            return true;
-        }
-        if (a.fractional[a_i] < b.fractional[b_i]) {
-            return false;
+// Walks both magnitudes from the top limb down with the radix points aligned, limbs
+// missing on either side count as zeros
+int FixedPoint::compare_abs(const FixedPoint &a, const FixedPoint &b) {
+    size_t high = std::max(a.int_limbs(), b.int_limbs());
+    size_t low = std::max(a.frac_limbs, b.frac_limbs);
+    for (size_t k = high + low; k-- > 0;) {
+        size_t ia = k + a.frac_limbs, ib = k + b.frac_limbs;
+        uint32_t val_a = ia >= low && ia - low < a.limb.size() ? a.limb[ia - low] : 0;
+        uint32_t val_b = ib >= low && ib - low < b.limb.size() ? b.limb[ib - low] : 0;
+        if (val_a != val_b) {
+            return val_a > val_b ? 1 : -1;
         }
     }
+    return 0;
+}
 
-    if (a_i == -1 && b_i == -1) return false;
-    if (a_i == -1) return false;
-    return true;
+void FixedPoint::widen_fraction(size_t frac_sz) {
+    limb.insert(limb.begin(), frac_sz - frac_limbs, 0);
+    frac_limbs = frac_sz;
 }
 
-bool FixedPoint::less_abs(const FixedPoint &a, const FixedPoint &b) const {
-    for (int i = std::max(a.integer.size(), b.integer.size()) - 1; i >= 0; i--) {
-        uint32_t val_a = ((uint32_t) i) < a.integer.size() ? a.integer[i] : 0;
-        uint32_t val_b = ((uint32_t) i) < b.integer.size() ? b.integer[i] : 0;
-        if (val_a < val_b) {
-            return true;
-        }
-        if (val_a > val_b) {
-            return false;
-        }
+// |this| += |other| in place. Magnitudes are aligned at the radix point, so a longer
+// fractional part of other extends this one with low zero limbs first
+void FixedPoint::add_magnitude(const FixedPoint &other) {
+    if (frac_limbs < other.frac_limbs) {
+        widen_fraction(other.frac_limbs);
     }
-
-    int a_i = a.fractional.size() - 1, b_i = b.fractional.size() - 1;
-    for (; a_i >= 0 && b_i >= 0; a_i--, b_i--) {
-        if (a.fractional[a_i] < b.fractional[b_i]) {
-            return true;
-        }
-        if (a.fractional[a_i] > b.fractional[b_i]) {
-            return false;
-        }
+    if (int_limbs() < other.int_limbs()) {
+        limb.resize(frac_limbs + other.int_limbs(), 0);
     }
-    if (a_i == -1 && b_i == -1) return false;
-    if (b_i == -1) return false;
-    return true;
-}
-
-// Function to add fractional parts of two numbers
-std::pair<std::vector<uint32_t>, bool> FixedPoint::add_frac(const std::vector<uint32_t> &a,
-                                                            const std::vector<uint32_t> &b,
-                                                            uint32_t carry) const {
-    std::vector<uint32_t> result;
-    size_t max_sz = std::max(a.size(), b.size());
-
-    size_t a_i = 0, b_i = 0;
-
-    // Perform addition bit by bit
-    while (a_i < max_sz && b_i < max_sz) {
-        if (b_i < max_sz - a.size()) {
-            result.push_back(b[b_i++]);
-            continue;
-        }
-        if (a_i < max_sz - b.size()) {
-            result.push_back(a[a_i++]);
-            continue;
-        }
 
-        result.push_back(0);
+    size_t offset = frac_limbs - other.frac_limbs;
+    uint32_t carry = limbs::add(limb.data() + offset, limb.data() + offset, limb.size() - offset,
+                                other.limb.data(), other.limb.size());
 
-        for (size_t j = 0; j < 32; ++j) {
-            uint32_t addition = (carry == 1 ? 0xFFFFFFFF : 0);
-            result.back() = result.back() | ((a[a_i] ^ b[b_i] ^ addition) & (1 << j));
-            carry = (((a[a_i] & (1 << j)) && (b[b_i] & (1 << j))) ||
-                    (((a[a_i] ^ b[b_i]) & (1 << j)) && addition) ? 1 : 0);
-        }
-        a_i++;
-        b_i++;
+    // If there's still a carry, append it to the integer part
+    if (carry) {
+        limb.push_back(1);
     }
-    return std::make_pair(result, carry);
 }
 
-// Function to add integer parts of two numbers
-std::pair<std::vector<uint32_t>, bool> FixedPoint::add_int(const std::vector<uint32_t> &a,
-                                                           const std::vector<uint32_t> &b,
-                                                           uint32_t carry) const {
-    std::vector<uint32_t> result;
-    size_t max_sz = std::max(a.size(), b.size());
+// |this| = ||this| - |other|| in place, returns true when |other| was the bigger one
+bool FixedPoint::sub_magnitude(const FixedPoint &other) {
+    bool other_bigger = compare_abs(*this, other) < 0;
 
-    for (size_t i = 0; i < max_sz; ++i) {
-        if (i >= a.size()) {
-            result.push_back(b[i] + carry);
-            carry = (b[i] + carry) == 0;
-            continue;
-        }
-        if (i >= b.size()) {
-            result.push_back(a[i] + carry);
-            carry = (a[i] + carry) == 0;
-            continue;
-        }
-
-        result.push_back(0);
-
-        for (size_t j = 0; j < 32; ++j) {
-            uint32_t addition = (carry == 1 ? 0xFFFFFFFF : 0);
-            result.back() = result.back() | ((a[i] ^ b[i] ^ addition) & (1 << j));
-            carry = (((a[i] & (1 << j)) && (b[i] & (1 << j))) ||
-                    (((a[i] ^ b[i]) & (1 << j)) && addition) ? 1 : 0);
-        }
+    if (frac_limbs < other.frac_limbs) {
+        widen_fraction(other.frac_limbs);
+    }
+    if (int_limbs() < other.int_limbs()) {
+        limb.resize(frac_limbs + other.int_limbs(), 0);
     }
-    return std::make_pair(result, carry);
-}
-
-std::pair<std::vector<uint32_t>, std::vector<uint32_t>>
-FixedPoint::subtract_nums(const FixedPoint &a, const FixedPoint &b) const {
-    std::vector<uint32_t> result_int;
-    std::vector<uint32_t> result_frac;
-
-    size_t a_int_sz = a.integer.size();
-    size_t a_frac_sz = a.fractional.size();
-    size_t b_int_sz = b.integer.size();
-    size_t b_frac_sz = b.fractional.size();
-
-    // Determine the maximum size of the combined integer and fractional parts
-    size_t max_sz = std::max(a_int_sz + a_frac_sz, b_int_sz + b_frac_sz);
-    size_t max_frac_sz = std::max(a_frac_sz, b_frac_sz);
-
-    uint32_t borrow = 0; // Borrow flag for subtraction
-
-    size_t a_i = 0, b_i = 0;
-
-    // Perform subtraction bit by bit for both fractional and integer parts
-    while (a_i < max_sz && b_i < max_sz) {
-        if (a_i < max_frac_sz && b_i < max_frac_sz) {
-            result_frac.push_back(0); // Initialize fractional result
-        } else {
-            result_int.push_back(0); // Initialize integer result
-        }
-
-        // Handle cases where one operand has fewer fractional bits than the other
-        if (b_i < max_frac_sz - a_frac_sz) {
-            borrow = subtract(result_frac.back(), 0, b.fractional[b_i++], borrow);
-            continue;
-        }
-
-        if (a_i < max_frac_sz - b_frac_sz) {
-            borrow = subtract(result_frac.back(), a.fractional[a_i++], 0, borrow);
-            continue;
-        }
 
-        // Subtract corresponding fractional bits
-        if (a_i < max_frac_sz && b_i < max_frac_sz) {
-            borrow = subtract(result_frac.back(), a.fractional[a_i++], b.fractional[b_i++], borrow);
-            continue;
-        }
+    size_t offset = frac_limbs - other.frac_limbs;
+    uint32_t *dst = limb.data() + offset;
 
-        // Subtract corresponding integer bits
-        uint32_t val_a = (a_i - a_frac_sz < a_int_sz) ? a.integer[a_i++ - a_frac_sz] : 0;
-        uint32_t val_b = (b_i - b_frac_sz < b_int_sz) ? b.integer[b_i++ - b_frac_sz] : 0;
-        borrow = subtract(result_int.back(), val_a, val_b, borrow);
+    if (!other_bigger) {
+        // Below offset other has only zero limbs, so the low limbs stay as they are
+        limbs::sub(dst, dst, limb.size() - offset, other.limb.data(), other.limb.size());
+    } else {
+        // other - this: limbs of this above the integer part of other are zero
+        uint32_t borrow = limbs::neg_n(limb.data(), limb.data(), offset);
+        limbs::sub_n(dst, other.limb.data(), dst, other.limb.size(), borrow);
     }
 
-    return std::make_pair(result_int, result_frac);
+    return other_bigger;
 }
 
-// Function to perform subtraction of two 32-bit words with borrow
-int FixedPoint::subtract(uint32_t &res, uint32_t val_a, uint32_t val_b, uint32_t borrow) const {
-    uint32_t int_res = val_a ^ val_b;
-    for (size_t bit_i = 0; bit_i < 32; bit_i++) {
-        switch (borrow) {
-        case 0:
-            res = res | (int_res & (1 << bit_i));
-            if ((val_a & (1 << bit_i)) == 0 && (val_b & (1 << bit_i)) != 0) {
-                borrow = 1; // Set borrow if a bit needs to be borrowed
-            }
-            break;
-        case 1:
-            res = res | ((~int_res) & (1 << bit_i));
-            if ((val_a & (1 << bit_i)) != 0 && (val_b & (1 << bit_i)) == 0) {
-                borrow = 0; // Clear borrow if the borrow is resolved
-            }
-            break;
-        }
-    }
-    return borrow;
+// Computes the product magnitude of both operands, the fractional limbs of both come first
+LimbVector FixedPoint::multiply(const FixedPoint &other) const {
+    // The product has exactly this_sz + other_sz limbs
+    LimbVector product(limb.size() + other.limb.size());
+    limbs::mul(product.data(), limb.data(), limb.size(), other.limb.data(), other.limb.size());
+    return product;
 }
 
-std::vector<uint32_t> FixedPoint::subtract_vec(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b) const {
-    uint32_t borrow = 0; // Borrow flag for subtraction
-
-    uint32_t a_i = 0, b_i = 0;
-    uint32_t max_sz = std::max(a.size(), b.size());
-
-    std::vector<uint32_t> result;
-
-    // Perform subtraction bit by bit for both fractional and integer parts
-    while (a_i < max_sz && b_i < max_sz) {
-        result.push_back(0);
-
-        uint32_t val_a = (a_i < a.size()) ? a[a_i++] : 0;
-        uint32_t val_b = (b_i < b.size()) ? b[b_i++] : 0;
-        borrow = subtract(result.back(), val_a, val_b, borrow);
-    }
-    return result;
+// Division by long divisors multiplies by a Newton reciprocal instead
+bool FixedPoint::use_reciprocal(const FixedPoint &divisor) const {
+    size_t divisor_sz = limbs::normalized_size(divisor.limb.data(), divisor.limb.size());
+    return divisor_sz >= limbs::div_thresholds().newton;
 }
 
-std::pair<std::vector<uint32_t>, std::vector<uint32_t>>
-FixedPoint::divide(const FixedPoint &a, const FixedPoint &b) const {
-
-    std::vector<uint32_t> result_int;
-    std::vector<uint32_t> result_frac;
-
-    uint32_t a_int_sz  = a.integer.size();
-    uint32_t a_frac_sz = a.fractional.size();
-    uint32_t b_frac_sz = b.fractional.size();
-
-    uint32_t a_sz = a_int_sz + a_frac_sz;
-
-    FixedPoint Remainder{0, 0};
-    uint32_t bit_taken = 0;
-
-    FixedPoint Divider{0, 0};
-    std::vector<uint32_t> divider(b.fractional);
-    divider.insert(divider.end(), b.integer.begin(), b.integer.end());
-
-    if (divider.empty()) {
+// The quotient keeps the fractional limbs of both operands: q = floor(a_mag * 2^(64 * b_frac) / b_mag),
+// so the dividend is the magnitude of a shifted up by twice the fractional limbs of the divisor
+LimbVector FixedPoint::divide(const FixedPoint &a, const FixedPoint &b) const {
+    size_t divider_sz = limbs::normalized_size(b.limb.data(), b.limb.size());
+    if (divider_sz == 0) {
         throw std::runtime_error("Attempted division by zero");
     }
 
-    Divider.integer = divider;
-
-    for (uint32_t bit_i = 0; bit_i < (a_sz + 2 * b_frac_sz) * 32; bit_i++) {
-
-        uint32_t addition;
-
-        if (bit_i < a_int_sz * 32) {
-            addition = ((a.integer[a_int_sz - 1 - (bit_i / 32)] >> (31 - bit_taken)) & 0x00000001);
-            add_bit_div(Remainder.integer, bit_i, addition);
-        } else if (bit_i < (a_int_sz + a_frac_sz) * 32) {
-            addition = ((a.fractional[a_frac_sz - 1 - ((bit_i - a_int_sz * 32) / 32)] >> (31 - bit_taken)) & 0x00000001);
-            add_bit_div(Remainder.integer, bit_i, addition);
-        } else {
-            add_bit_div(Remainder.integer, bit_i, false);
-        }
+    LimbVector dividend(2 * b.frac_limbs + a.limb.size());
+    std::copy(a.limb.begin(), a.limb.end(), dividend.begin() + 2 * b.frac_limbs);
 
-        bit_taken = (bit_taken + 1) % 32;
-
-        if (Remainder >= Divider) {
-            Remainder -= Divider;
-            if (bit_i / 32 < a_int_sz + b_frac_sz)
-                add_bit_div(result_int, bit_i, true);
-            else
-                add_bit_div(result_frac, bit_i, true);
-        } else {
-            if (bit_i / 32 < a_int_sz + b_frac_sz)
-                add_bit_div(result_int, bit_i, false);
-            else
-                add_bit_div(result_frac, bit_i, false);
-        }
+    // At least one integer limb above the fractional ones
+    LimbVector quotient(std::max(dividend.size() + 1, a.frac_limbs + b.frac_limbs + 1 + divider_sz) - divider_sz);
+    if (dividend.size() >= divider_sz) {
+        limbs::divmod_basecase(quotient.data(), nullptr, dividend.data(), dividend.size(), b.limb.data(), divider_sz);
     }
-
-    return std::make_pair(result_int, result_frac);
+    return quotient;
 }
 
-bool FixedPoint::not_less_vec(const std::vector<uint32_t> &a, const std::vector<uint32_t> &b) const {
+LimbVector FixedPoint::divide(const FixedPoint &a, const Reciprocal &b) const {
+    LimbVector dividend(2 * b.frac_limbs + a.limb.size());
+    std::copy(a.limb.begin(), a.limb.end(), dividend.begin() + 2 * b.frac_limbs);
 
-    for (int i = std::max(a.size(), b.size()) - 1; i >= 0; i--) {
-        uint32_t val_a = (((uint32_t) i) < a.size() ? a[i] : 0);
-        uint32_t val_b = (((uint32_t) i) < b.size() ? b[i] : 0);
-        if (val_a > val_b) {
-            return true;
-        }
-        if (val_a < val_b) {
-            return false;
-        }
+    size_t divider_sz = b.inverse.divisor.size();
+    // At least one integer limb above the fractional ones
+    LimbVector quotient(std::max(dividend.size() + 1, a.frac_limbs + b.frac_limbs + 1 + divider_sz) - divider_sz);
+    if (dividend.size() >= divider_sz) {
+        limbs::divmod(quotient.data(), nullptr, dividend.data(), dividend.size(), b.inverse);
     }
-
-    return true;
-}
-
-void FixedPoint::add_bit_div(std::vector<uint32_t> &vec, uint32_t bit_added, bool is_one) const {
-    if (bit_added % 32 == 0 || vec.back() & 0x80000000) vec.push_back(0);
-    for (uint32_t i = vec.size() - 1; i > 0; i--) {
-        vec[i] <<= 1;
-        vec[i] |= vec[i - 1] >> 31;
-    }
-    vec[0] <<= 1;
-    vec[0] |= (is_one ? 1 : 0);
+    return quotient;
 }
 
 // Function to convert an integer part from decimal to binary
 std::vector<uint32_t> FixedPoint::int_part_to_bin(const std::string &num_str) const {
-    std::string cur_num_str = num_str;  // Copy of the input string
-    std::vector<uint32_t> binary_result; // To store the binary result
-
-    if (cur_num_str == "0") {
+    std::vector<uint32_t> binary_result = limbs::from_decimal(num_str.data(), num_str.size());
+    if (binary_result.empty()) {
         binary_result.push_back(0);
-        return binary_result;
-    }
-
-    int bit_added = 0;
-
-    // Repeatedly divide the number by 2 to extract binary digits
-    while (cur_num_str != "0") {
-        int remainder = 0;
-        std::string result;
-
-        for (char digit_c : cur_num_str) {
-            int cur_digit = (digit_c - '0') + remainder * 10;
-            int quotient = cur_digit / 2;
-            remainder = cur_digit % 2;
-
-            result += std::to_string(quotient);
-        }
-
-        // Remove leading zeros from the result
-        result.erase(0, result.find_first_not_of('0'));
-        if (result.empty()) {
-            result = "0";
-        }
-
-        if (bit_added == 0) binary_result.push_back(0);
-
-        binary_result.back() = binary_result.back() | (remainder << bit_added);
-
-        cur_num_str = result;
-        bit_added = (bit_added + 1) % 32;
     }
-
     return binary_result;
 }
 
-// Function to multiply a decimal string by 2
-std::string FixedPoint::mult_by_two(const std::string &num_str) const {
-    std::string result = "";
-    int carry = 0;
-
-    for (int i = num_str.size() - 1; i >= 0; i--) {
-        int value = (num_str[i] - '0') * 2 + carry;
-        carry = value / 10;
-        result = std::to_string(value % 10) + result;
+// Function to convert a fractional part from decimal to binary: the first frac_bits bits
+// of digits / 10^len, left-aligned in ceil(frac_bits / 32) limbs
+std::vector<uint32_t> FixedPoint::frac_to_binary(const std::string &frac_str, int frac_bits) const {
+    if (frac_bits <= 0) {
+        return {};
     }
+    size_t frac_sz = (frac_bits + 31) / 32;
 
-    if (carry > 0) {
-        result = std::to_string(carry) + result;
+    // An empty fraction ("7.") is zero at the requested precision, like a missing one
+    if (frac_str.empty()) {
+        return std::vector<uint32_t>(frac_sz, 0);
     }
 
-    return result;
-}
+    // floor(digits * 2^(32 * frac_sz) / 10^len), then the bits past frac_bits are cleared
+    std::vector<uint32_t> num(frac_sz, 0);
+    std::vector<uint32_t> digits = limbs::from_decimal(frac_str.data(), frac_str.size());
+    num.insert(num.end(), digits.begin(), digits.end());
 
-// Function to convert a fractional part from decimal to binary
-std::vector<uint32_t> FixedPoint::frac_to_binary(const std::string &frac_str, int frac_bits) const {
-    std::vector<uint32_t> binary;
-    std::string frac_part = frac_str;
-    uint32_t frac_part_size = frac_part.size();
-
-    for (int i = 0, bit_added = 0; i < frac_bits && !frac_part.empty(); ++i, bit_added = (bit_added + 1) % 32) {
-        // Multiply the fractional part by 2
-        std::string multiplied = mult_by_two(frac_part);
-
-        if (bit_added == 0) binary.insert(binary.begin(), 0);
-
-        if (multiplied.size() == frac_part_size) {
-            binary[0] = (binary[0] << 1) | 0;
-            frac_part = multiplied;
-        } else {
-            binary[0] = (binary[0] << 1) | 1;
-            frac_part = multiplied.substr(1);
-        }
-
-        if (multiplied.size() == 0) {
-            frac_part = "0";
-        }
+    std::vector<uint32_t> scale = limbs::pow_1(10, frac_str.size());
+    std::vector<uint32_t> binary(num.size() + 1, 0);
+    if (scale.size() >= limbs::div_thresholds().newton) {
+        limbs::divmod(binary.data(), nullptr, num.data(), num.size(), limbs::Reciprocal(scale.data(), scale.size()));
+    } else {
+        limbs::divmod_basecase(binary.data(), nullptr, num.data(), num.size(), scale.data(), scale.size());
     }
-    if (!binary.empty())
-        binary[0] <<= 32 - (frac_bits % 32);
 
+    binary.resize(frac_sz);
+    binary[0] &= 0xFFFFFFFFu << (32 * frac_sz - frac_bits);
     return binary;
 }
 
@@ -876,5 +747,5 @@ FixedPoint::decimal_to_binary(const std::string& num_str, int frac_bits) const {
 
 // User-defined literal operator for creating FixedPoint objects
 FixedPoint operator""_long(long double number) {
-    return FixedPoint(std::to_string(number), 64); // Replace this with actual logic if needed
+    return FixedPoint(static_cast<double>(number), 64);
 }
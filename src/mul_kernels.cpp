@@ -0,0 +1,458 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "../include/limbs.hpp"
+
+// Schoolbook multiplication kernels behind mul_basecase. Limbs stay 32-bit in memory;
+// the wide kernels read a little-endian limb array as 64-bit words, so one multiply
+// instruction covers four times the bits of a 32 x 32-bit product.
+
+namespace limbs {
+
+namespace {
+
+using u64 = uint64_t;
+__extension__ typedef unsigned __int128 u128; // -pedantic knows no 128-bit integers
+
+constexpr bool HOST_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+// Operands up to this many words are converted on the stack
+constexpr size_t LOCAL_WORDS = 256;
+
+// Scratch words for one multiplication, on the stack when they fit
+class Words {
+public:
+    explicit Words(size_t n) : ptr(n <= LOCAL_WORDS ? local : (heap.resize(n), heap.data())) {}
+    u64 *data() { return ptr; }
+
+private:
+    u64 local[LOCAL_WORDS];
+    std::vector<u64> heap;
+    u64 *ptr;
+};
+
+void mul_portable(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    std::fill(r, r + an + bn, 0);
+
+    for (size_t i = 0; i < an; i++) {
+        // Sparse operands (e.g. small integers with wide fractional parts) are mostly zeros
+        if (a[i] == 0) continue;
+
+        dlimb_t carry = 0;
+        for (size_t j = 0; j < bn; j++) {
+            // a[i] * b[j] + r[i + j] + carry never exceeds 2^64 - 1
+            dlimb_t cur = static_cast<dlimb_t>(a[i]) * b[j] + r[i + j] + carry;
+            r[i + j] = static_cast<limb_t>(cur);
+            carry = cur >> LIMB_BITS;
+        }
+        r[i + bn] = static_cast<limb_t>(carry);
+    }
+}
+
+// Products a[i] * a[j] with i < j, which a square has twice each, then doubled and the
+// squares a[i]^2 added on the diagonal
+void sqr_portable(limb_t *r, const limb_t *a, size_t n) {
+    std::fill(r, r + 2 * n, 0);
+
+    for (size_t i = 0; i + 1 < n; i++) {
+        if (a[i] == 0) continue;
+
+        dlimb_t carry = 0;
+        for (size_t j = i + 1; j < n; j++) {
+            dlimb_t cur = static_cast<dlimb_t>(a[i]) * a[j] + r[i + j] + carry;
+            r[i + j] = static_cast<limb_t>(cur);
+            carry = cur >> LIMB_BITS;
+        }
+        r[i + n] = static_cast<limb_t>(carry);
+    }
+
+    limb_t shifted_out = 0;
+    for (size_t i = 0; i < 2 * n; i++) {
+        limb_t top = r[i] >> (LIMB_BITS - 1);
+        r[i] = (r[i] << 1) | shifted_out;
+        shifted_out = top;
+    }
+
+    dlimb_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        // a[i]^2 + r[2i] + carry never exceeds 2^64 - 1 either
+        dlimb_t cur = static_cast<dlimb_t>(a[i]) * a[i] + r[2 * i] + carry;
+        r[2 * i] = static_cast<limb_t>(cur);
+        cur = (cur >> LIMB_BITS) + r[2 * i + 1];
+        r[2 * i + 1] = static_cast<limb_t>(cur);
+        carry = cur >> LIMB_BITS;
+    }
+}
+
+// Reads n limbs as (n + 1) / 2 words, the odd top limb gets a zero upper half
+void load_words(u64 *w, const limb_t *a, size_t n) {
+    w[n / 2] = 0;
+    std::memcpy(w, a, n * sizeof(limb_t));
+}
+
+// r[0 .. n) += a[0 .. n) * b, returns the word carried out
+u64 addmul_1_wide(u64 *r, const u64 *a, size_t n, u64 b) {
+    u64 carry = 0;
+    for (size_t j = 0; j < n; j++) {
+        u128 cur = static_cast<u128>(a[j]) * b + r[j] + carry;
+        r[j] = static_cast<u64>(cur);
+        carry = static_cast<u64>(cur >> 64);
+    }
+    return carry;
+}
+
+#if defined(__x86_64__)
+
+// Same row with MULX, which leaves the flags alone, and two independent carry chains:
+// ADCX adds the old r[j] through CF, ADOX the high word of the previous product through
+// OF. LEA and JRCXZ keep the loop from touching either flag.
+u64 addmul_1_mulx(u64 *r, const u64 *a, size_t n, u64 b) {
+    u64 high = 0, lo, hi;
+    asm volatile(
+        "xor %k[lo], %k[lo]\n\t" // Clears CF and OF
+        "1:\n\t"
+        "jrcxz 2f\n\t"
+        "mulx (%[a]), %[lo], %[hi]\n\t"
+        "adcx (%[r]), %[lo]\n\t"
+        "adox %[high], %[lo]\n\t"
+        "mov %[lo], (%[r])\n\t"
+        "mov %[hi], %[high]\n\t"
+        "lea 8(%[a]), %[a]\n\t"
+        "lea 8(%[r]), %[r]\n\t"
+        "lea -1(%[n]), %[n]\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "mov $0, %k[lo]\n\t"
+        "adcx %[lo], %[high]\n\t"
+        "adox %[lo], %[high]\n\t"
+        : [a] "+r"(a), [r] "+r"(r), [n] "+c"(n), [high] "+r"(high), [lo] "=&r"(lo), [hi] "=&r"(hi)
+        : "d"(b)
+        : "cc", "memory");
+    return high;
+}
+
+#endif
+
+// Below this many limbs in the shorter operand the word kernels do not recover the
+// cost of converting the operands and use the 32-bit loop
+constexpr size_t WORDS_MIN_LIMBS = 4;
+
+// Schoolbook product over 64-bit words, one row of addmul_1 per word of a. The product
+// of an + bn limbs fits, so the upper half of an odd top word comes out zero.
+template <u64 (*addmul_1)(u64 *, const u64 *, size_t, u64)>
+void mul_words(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    if (std::min(an, bn) < WORDS_MIN_LIMBS) {
+        mul_portable(r, a, an, b, bn);
+        return;
+    }
+
+    size_t aw = (an + 1) / 2, bw = (bn + 1) / 2;
+    Words buffer(2 * (aw + bw));
+    u64 *x = buffer.data(), *y = x + aw, *z = y + bw;
+    load_words(x, a, an);
+    load_words(y, b, bn);
+    std::fill(z, z + aw + bw, 0);
+
+    for (size_t i = 0; i < aw; i++) {
+        if (x[i] == 0) continue;
+        z[i + bw] = addmul_1(z + i, y, bw, x[i]);
+    }
+    std::memcpy(r, z, (an + bn) * sizeof(limb_t));
+}
+
+// sqr_portable over 64-bit words, the off-diagonal rows through addmul_1
+template <u64 (*addmul_1)(u64 *, const u64 *, size_t, u64)>
+void sqr_words(limb_t *r, const limb_t *a, size_t n) {
+    if (n < WORDS_MIN_LIMBS) {
+        sqr_portable(r, a, n);
+        return;
+    }
+
+    size_t w = n / 2 + n % 2; // (n + 1) / 2, written so GCC sees no wrap-around into memcpy
+    Words buffer(3 * w);
+    u64 *x = buffer.data(), *z = x + w;
+    load_words(x, a, n);
+    std::fill(z, z + 2 * w, 0);
+
+    for (size_t i = 0; i + 1 < w; i++) {
+        if (x[i] == 0) continue;
+        z[i + w] = addmul_1(z + 2 * i + 1, x + i + 1, w - i - 1, x[i]);
+    }
+
+    u64 shifted_out = 0;
+    for (size_t i = 0; i < 2 * w; i++) {
+        u64 top = z[i] >> 63;
+        z[i] = (z[i] << 1) | shifted_out;
+        shifted_out = top;
+    }
+
+    u64 carry = 0;
+    for (size_t i = 0; i < w; i++) {
+        u128 cur = static_cast<u128>(x[i]) * x[i] + z[2 * i] + carry;
+        z[2 * i] = static_cast<u64>(cur);
+        cur = (cur >> 64) + z[2 * i + 1];
+        z[2 * i + 1] = static_cast<u64>(cur);
+        carry = static_cast<u64>(cur >> 64);
+    }
+    std::memcpy(r, z, 2 * n * sizeof(limb_t));
+}
+
+void mul_wide(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    mul_words<addmul_1_wide>(r, a, an, b, bn);
+}
+
+void sqr_wide(limb_t *r, const limb_t *a, size_t n) {
+    sqr_words<addmul_1_wide>(r, a, n);
+}
+
+#if defined(__x86_64__)
+
+void mul_mulx(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    mul_words<addmul_1_mulx>(r, a, an, b, bn);
+}
+
+void sqr_mulx(limb_t *r, const limb_t *a, size_t n) {
+    sqr_words<addmul_1_mulx>(r, a, n);
+}
+
+constexpr unsigned DIGIT_BITS = 52;
+constexpr u64 DIGIT_MASK = (u64(1) << DIGIT_BITS) - 1;
+
+// The column sums of 52-bit halves stay below 2^64 while the shorter operand has fewer
+// digits than this; longer ones go through the MULX kernel
+constexpr size_t IFMA_MAX_DIGITS = 2048;
+
+size_t digit_count(size_t n) {
+    return (n * LIMB_BITS + DIGIT_BITS - 1) / DIGIT_BITS;
+}
+
+// Splits a[0 .. n) into 52-bit digits. Digit t starts at bit 52 * t, i.e. at a byte
+// boundary or four bits past one, so an unaligned 64-bit read holds all of it.
+void to_digits(u64 *d, const limb_t *a, size_t n) {
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(a);
+    size_t total = n * sizeof(limb_t);
+    for (size_t t = 0, count = digit_count(n); t < count; t++) {
+        size_t bit = t * DIGIT_BITS, at = bit / 8;
+        u64 window = 0;
+        std::memcpy(&window, bytes + at, std::min<size_t>(8, total - at));
+        d[t] = (window >> (bit % 8)) & DIGIT_MASK;
+    }
+}
+
+// Packs 52-bit digits d[0 .. count) into r[0 .. n) through a 128-bit bit accumulator;
+// the digits past the n limbs have to be zero
+void from_digits(limb_t *r, size_t n, const u64 *d, size_t count) {
+    u128 pending = 0;
+    unsigned bits = 0;
+    size_t i = 0;
+    for (size_t t = 0; t < count && i < n; t++) {
+        pending |= static_cast<u128>(d[t]) << bits;
+        bits += DIGIT_BITS;
+        for (; bits >= LIMB_BITS && i < n; bits -= LIMB_BITS) {
+            r[i++] = static_cast<limb_t>(pending);
+            pending >>= LIMB_BITS;
+        }
+    }
+    for (; i < n; i++) {
+        r[i] = static_cast<limb_t>(pending);
+        pending >>= LIMB_BITS;
+    }
+}
+
+// Product scanning over 52-bit digits, sixteen columns at a time: every digit of a is
+// broadcast and multiplied with the digits of b that land in those columns.
+// VPMADD52LUQ/HUQ add the low and high 52 bits of each product to the lanes, the
+// high halves belong one column up. b is padded with zero digits on both sides, so
+// the loads never leave the buffer and need no masks.
+__attribute__((target("avx512f,avx512ifma")))
+void mul_ifma(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    size_t da = digit_count(an), db = digit_count(bn);
+    if (std::min(da, db) >= IFMA_MAX_DIGITS) {
+        mul_mulx(r, a, an, b, bn);
+        return;
+    }
+
+    size_t cols = (da + db + 15) / 16 * 16;
+    Words buffer(da + db + 32 + 2 * cols);
+    u64 *x = buffer.data(), *y = x + da, *lo = y + db + 32, *hi = lo + cols;
+    to_digits(x, a, an);
+    std::fill(y, y + db + 32, 0);
+    to_digits(y + 16, b, bn);
+    const u64 *yb = y + 16;
+
+    // Sixteen columns per pass and even and odd digits of a in separate sums: eight
+    // independent accumulators hide the latency of the multiply-adds
+    for (size_t k = 0; k < cols; k += 16) {
+        size_t first = k + 1 > db ? k + 1 - db : 0;
+        size_t last = std::min(da, k + 16);
+        __m512i sums[8];
+        for (__m512i &sum : sums) sum = _mm512_setzero_si512();
+        size_t i = first;
+        for (; i + 2 <= last; i += 2) {
+            __m512i d0 = _mm512_set1_epi64(static_cast<long long>(x[i]));
+            __m512i d1 = _mm512_set1_epi64(static_cast<long long>(x[i + 1]));
+            __m512i c00 = _mm512_loadu_si512(yb + k - i), c01 = _mm512_loadu_si512(yb + k + 8 - i);
+            __m512i c10 = _mm512_loadu_si512(yb + k - i - 1), c11 = _mm512_loadu_si512(yb + k + 7 - i);
+            sums[0] = _mm512_madd52lo_epu64(sums[0], d0, c00);
+            sums[1] = _mm512_madd52hi_epu64(sums[1], d0, c00);
+            sums[2] = _mm512_madd52lo_epu64(sums[2], d0, c01);
+            sums[3] = _mm512_madd52hi_epu64(sums[3], d0, c01);
+            sums[4] = _mm512_madd52lo_epu64(sums[4], d1, c10);
+            sums[5] = _mm512_madd52hi_epu64(sums[5], d1, c10);
+            sums[6] = _mm512_madd52lo_epu64(sums[6], d1, c11);
+            sums[7] = _mm512_madd52hi_epu64(sums[7], d1, c11);
+        }
+        if (i < last) {
+            __m512i d0 = _mm512_set1_epi64(static_cast<long long>(x[i]));
+            __m512i c00 = _mm512_loadu_si512(yb + k - i), c01 = _mm512_loadu_si512(yb + k + 8 - i);
+            sums[0] = _mm512_madd52lo_epu64(sums[0], d0, c00);
+            sums[1] = _mm512_madd52hi_epu64(sums[1], d0, c00);
+            sums[2] = _mm512_madd52lo_epu64(sums[2], d0, c01);
+            sums[3] = _mm512_madd52hi_epu64(sums[3], d0, c01);
+        }
+        _mm512_storeu_si512(lo + k, _mm512_add_epi64(sums[0], sums[4]));
+        _mm512_storeu_si512(hi + k, _mm512_add_epi64(sums[1], sums[5]));
+        _mm512_storeu_si512(lo + k + 8, _mm512_add_epi64(sums[2], sums[6]));
+        _mm512_storeu_si512(hi + k + 8, _mm512_add_epi64(sums[3], sums[7]));
+    }
+
+    // Carries in radix 2^52, the digits reuse the low sums
+    u64 carry = 0;
+    for (size_t k = 0; k < da + db; k++) {
+        u64 cur = lo[k] + (k ? hi[k - 1] : 0) + carry;
+        lo[k] = cur & DIGIT_MASK;
+        carry = cur >> DIGIT_BITS;
+    }
+    from_digits(r, an + bn, lo, da + db);
+}
+
+// The column sums have no cheap way to skip the mirrored products, so a square is the
+// digit product of a with itself
+void sqr_ifma(limb_t *r, const limb_t *a, size_t n) {
+    mul_ifma(r, a, n, a, n);
+}
+
+bool cpu_has(MulKernel kernel) {
+    switch (kernel) {
+        case MulKernel::mulx_adx:
+            return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+        case MulKernel::ifma:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma");
+        default:
+            return true;
+    }
+}
+
+#else
+
+bool cpu_has(MulKernel kernel) {
+    return kernel == MulKernel::portable || kernel == MulKernel::wide;
+}
+
+#endif
+
+using Kernel = void (*)(limb_t *, const limb_t *, size_t, const limb_t *, size_t);
+
+Kernel kernel_function(MulKernel kernel) {
+    switch (kernel) {
+#if defined(__x86_64__)
+        case MulKernel::mulx_adx: return mul_mulx;
+        case MulKernel::ifma: return mul_ifma;
+#endif
+        case MulKernel::wide: return mul_wide;
+        default: return mul_portable;
+    }
+}
+
+using Square = void (*)(limb_t *, const limb_t *, size_t);
+
+Square square_function(MulKernel kernel) {
+    switch (kernel) {
+#if defined(__x86_64__)
+        case MulKernel::mulx_adx: return sqr_mulx;
+        case MulKernel::ifma: return sqr_ifma;
+#endif
+        case MulKernel::wide: return sqr_wide;
+        default: return sqr_portable;
+    }
+}
+
+const MulKernel ALL_KERNELS[] = {MulKernel::portable, MulKernel::wide, MulKernel::mulx_adx, MulKernel::ifma};
+
+// The fastest supported kernel, or the one FIXED_POINT_MUL_KERNEL names
+MulKernel initial_kernel() {
+    if (const char *name = std::getenv("FIXED_POINT_MUL_KERNEL")) {
+        for (MulKernel kernel : ALL_KERNELS) {
+            if (name == std::string(mul_kernel_name(kernel)) && mul_kernel_supported(kernel)) {
+                return kernel;
+            }
+        }
+    }
+    for (MulKernel kernel : {MulKernel::mulx_adx, MulKernel::wide}) {
+        if (mul_kernel_supported(kernel)) return kernel;
+    }
+    return MulKernel::portable;
+}
+
+struct Selection {
+    MulKernel kernel;
+    Kernel function;
+    Square square;
+};
+
+Selection select(MulKernel kernel) {
+    return {kernel, kernel_function(kernel), square_function(kernel)};
+}
+
+Selection &selection() {
+    static Selection current = select(initial_kernel());
+    return current;
+}
+
+} // namespace
+
+bool mul_kernel_supported(MulKernel kernel) {
+    if (kernel != MulKernel::portable && !HOST_LITTLE_ENDIAN) {
+        return false;
+    }
+    return cpu_has(kernel);
+}
+
+const char *mul_kernel_name(MulKernel kernel) {
+    switch (kernel) {
+        case MulKernel::wide: return "wide";
+        case MulKernel::mulx_adx: return "mulx_adx";
+        case MulKernel::ifma: return "ifma";
+        default: return "portable";
+    }
+}
+
+MulKernel mul_kernel() {
+    return selection().kernel;
+}
+
+void set_mul_kernel(MulKernel kernel) {
+    if (!mul_kernel_supported(kernel)) {
+        throw std::runtime_error(std::string("Multiplication kernel ") + mul_kernel_name(kernel) +
+                                 " is not supported on this CPU");
+    }
+    selection() = select(kernel);
+}
+
+void mul_basecase(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    selection().function(r, a, an, b, bn);
+}
+
+void sqr_basecase(limb_t *r, const limb_t *a, size_t n) {
+    selection().square(r, a, n);
+}
+
+} // namespace limbs
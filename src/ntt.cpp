@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <vector>
+
+#include "../include/limbs.hpp"
+
+// Three-prime number-theoretic transform multiplication. Every prime is below 2^62
+// and has the form c * 2^k + 1 with k >= 55, so transforms of up to 2^55 points exist.
+// Coefficients are 64-bit words (two limbs), a convolution coefficient is below
+// 2^55 * 2^128 < p1 * p2 * p3 ~ 2^183, so the CRT reconstruction is exact.
+
+namespace limbs {
+
+namespace {
+
+using u64 = uint64_t;
+__extension__ typedef unsigned __int128 u128; // -pedantic knows no 128-bit integers
+
+// Arithmetic modulo one prime with values kept in Montgomery form (x * 2^64 mod p)
+struct Modulus {
+    u64 p;
+    u64 p_inv_neg; // -p^-1 mod 2^64
+    u64 r2;        // 2^128 mod p
+    u64 generator; // Primitive root modulo p
+
+    explicit Modulus(u64 prime, u64 root) : p(prime), generator(root) {
+        u64 inv = p; // Newton iteration for p^-1 mod 2^64, each step doubles the correct bits
+        for (int i = 0; i < 6; i++) inv *= 2 - p * inv;
+        p_inv_neg = -inv;
+        u128 r = (static_cast<u128>(1) << 64) % p;
+        r2 = static_cast<u64>(r * r % p);
+    }
+
+    // t * 2^-64 mod p for t < p * 2^64
+    u64 reduce(u128 t) const {
+        u64 m = static_cast<u64>(t) * p_inv_neg;
+        u64 res = static_cast<u64>((t + static_cast<u128>(m) * p) >> 64);
+        return res >= p ? res - p : res;
+    }
+
+    u64 mul(u64 a, u64 b) const { return reduce(static_cast<u128>(a) * b); }
+
+    u64 add(u64 a, u64 b) const {
+        u64 res = a + b;
+        return res >= p ? res - p : res;
+    }
+
+    u64 sub(u64 a, u64 b) const { return a >= b ? a - b : a + p - b; }
+
+    // Any 64-bit value into Montgomery form
+    u64 to_mont(u64 a) const { return reduce(static_cast<u128>(a) * r2); }
+
+    u64 pow(u64 base_mont, u64 exp) const {
+        u64 res = to_mont(1);
+        for (; exp; exp >>= 1) {
+            if (exp & 1) res = mul(res, base_mont);
+            base_mont = mul(base_mont, base_mont);
+        }
+        return res;
+    }
+
+    // Plain (non-Montgomery) inverse of a plain value
+    u64 inverse(u64 a) const { return reduce(pow(to_mont(a), p - 2)); }
+};
+
+const Modulus &modulus(int i) {
+    static const Modulus primes[3] = {
+        Modulus(4179340454199820289ULL, 3), // 29 * 2^57 + 1
+        Modulus(2485986994308513793ULL, 5), // 69 * 2^55 + 1
+        Modulus(1945555039024054273ULL, 5), // 27 * 2^56 + 1
+    };
+    return primes[i];
+}
+
+// tw[len + j] = w_{2 len}^j for every power of two len < n, in Montgomery form
+std::vector<u64> twiddles(const Modulus &m, size_t n, bool inverse) {
+    std::vector<u64> tw(std::max<size_t>(n, 2));
+    for (size_t len = 1; len < n; len <<= 1) {
+        u64 w = m.pow(m.to_mont(m.generator), (m.p - 1) / (2 * len));
+        if (inverse) w = m.pow(w, m.p - 2);
+        u64 cur = m.to_mont(1);
+        for (size_t j = 0; j < len; j++) {
+            tw[len + j] = cur;
+            cur = m.mul(cur, w);
+        }
+    }
+    return tw;
+}
+
+// Decimation in frequency: natural order in, bit-reversed order out
+void forward(std::vector<u64> &a, const std::vector<u64> &tw, const Modulus &m) {
+    size_t n = a.size();
+    for (size_t len = n / 2; len >= 1; len >>= 1) {
+        for (size_t i = 0; i < n; i += 2 * len) {
+            for (size_t j = 0; j < len; j++) {
+                u64 u = a[i + j], v = a[i + j + len];
+                a[i + j] = m.add(u, v);
+                a[i + j + len] = m.mul(m.sub(u, v), tw[len + j]);
+            }
+        }
+    }
+}
+
+// Decimation in time: bit-reversed order in, natural order out, scaled by n
+void backward(std::vector<u64> &a, const std::vector<u64> &tw, const Modulus &m) {
+    size_t n = a.size();
+    for (size_t len = 1; len < n; len <<= 1) {
+        for (size_t i = 0; i < n; i += 2 * len) {
+            for (size_t j = 0; j < len; j++) {
+                u64 u = a[i + j], v = m.mul(a[i + j + len], tw[len + j]);
+                a[i + j] = m.add(u, v);
+                a[i + j + len] = m.sub(u, v);
+            }
+        }
+    }
+}
+
+// Packs pairs of limbs into 64-bit coefficients, zero padded to n
+std::vector<u64> coefficients(const limb_t *a, size_t an, size_t n) {
+    std::vector<u64> res(n, 0);
+    for (size_t i = 0; i < an; i++) {
+        res[i / 2] |= static_cast<u64>(a[i]) << (LIMB_BITS * (i % 2));
+    }
+    return res;
+}
+
+// Cyclic convolution of a and b modulo prime number idx, plain values out. When b is
+// a itself only one forward transform is needed and its points are squared.
+std::vector<u64> convolve(const std::vector<u64> &a, const std::vector<u64> &b, int idx) {
+    const Modulus &m = modulus(idx);
+    size_t n = a.size();
+    bool square = &a == &b;
+
+    std::vector<u64> fa(n), fb(square ? 0 : n);
+    for (size_t i = 0; i < n; i++) fa[i] = m.to_mont(a[i]);
+    for (size_t i = 0; i < fb.size(); i++) fb[i] = m.to_mont(b[i]);
+
+    std::vector<u64> tw = twiddles(m, n, false);
+    forward(fa, tw, m);
+    if (square) {
+        for (size_t i = 0; i < n; i++) fa[i] = m.mul(fa[i], fa[i]);
+    } else {
+        forward(fb, tw, m);
+        for (size_t i = 0; i < n; i++) fa[i] = m.mul(fa[i], fb[i]);
+    }
+
+    tw = twiddles(m, n, true);
+    backward(fa, tw, m);
+
+    // Multiplying a Montgomery value by a plain n^-1 both unscales and leaves Montgomery form
+    u64 n_inv = m.inverse(n % m.p);
+    for (size_t i = 0; i < n; i++) fa[i] = m.mul(fa[i], n_inv);
+    return fa;
+}
+
+} // namespace
+
+void mul_ntt(limb_t *r, const limb_t *a, size_t an, const limb_t *b, size_t bn) {
+    size_t a_coeffs = (an + 1) / 2, b_coeffs = (bn + 1) / 2;
+    size_t n = 1;
+    while (n < a_coeffs + b_coeffs) n <<= 1;
+
+    // A square packs and transforms its operand once
+    bool square = a == b && an == bn;
+    std::vector<u64> ca = coefficients(a, an, n), cb;
+    if (!square) cb = coefficients(b, bn, n);
+    std::vector<u64> res[3];
+    for (int i = 0; i < 3; i++) res[i] = convolve(ca, square ? ca : cb, i);
+
+    const Modulus &m1 = modulus(0), &m2 = modulus(1), &m3 = modulus(2);
+    const u64 p1 = m1.p, p2 = m2.p, p3 = m3.p;
+    const u128 p1p2 = static_cast<u128>(p1) * p2;
+    const u64 p1p2_lo = static_cast<u64>(p1p2), p1p2_hi = static_cast<u64>(p1p2 >> 64);
+
+    // Montgomery forms of the CRT constants: m.mul(x, c_mont) == x * c mod p for plain x
+    const u64 p1_inv_p2 = m2.to_mont(m2.inverse(p1 % p2));
+    const u64 p1_p3 = m3.to_mont(p1 % p3);
+    const u64 p1p2_inv_p3 = m3.to_mont(m3.inverse(static_cast<u64>(p1p2 % p3)));
+
+    // Garner reconstruction x = r1 + p1 * v2 + p1 * p2 * v3 and carry propagation in
+    // base 2^64. The running carry always fits in 128 bits.
+    std::fill(r, r + an + bn, 0);
+    u128 carry = 0;
+    size_t out_words = (an + bn + 1) / 2;
+    for (size_t i = 0; i < out_words; i++) {
+        u64 r1 = res[0][i], r2 = res[1][i], r3 = res[2][i];
+
+        u64 r1_p2 = r1 >= p2 ? r1 - p2 : r1;
+        u64 v2 = m2.mul(m2.sub(r2, r1_p2), p1_inv_p2);
+        u128 x12 = static_cast<u128>(p1) * v2 + r1;
+
+        u64 r1_p3 = r1;
+        while (r1_p3 >= p3) r1_p3 -= p3;
+        u64 x12_p3 = m3.add(m3.mul(v2, p1_p3), r1_p3);
+        u64 v3 = m3.mul(m3.sub(r3, x12_p3), p1p2_inv_p3);
+
+        // 192-bit sum x12 + p1p2 * v3 + carry as (w2, w1, w0)
+        u128 lo = static_cast<u128>(p1p2_lo) * v3;
+        u128 hi = static_cast<u128>(p1p2_hi) * v3;
+
+        u128 acc = static_cast<u128>(static_cast<u64>(x12)) + static_cast<u64>(lo) + static_cast<u64>(carry);
+        u64 w0 = static_cast<u64>(acc);
+        acc = (acc >> 64) + static_cast<u64>(x12 >> 64) + static_cast<u64>(lo >> 64) +
+              static_cast<u64>(hi) + static_cast<u64>(carry >> 64);
+        u64 w1 = static_cast<u64>(acc);
+        u64 w2 = static_cast<u64>(acc >> 64) + static_cast<u64>(hi >> 64);
+
+        r[2 * i] = static_cast<limb_t>(w0);
+        if (2 * i + 1 < an + bn) r[2 * i + 1] = static_cast<limb_t>(w0 >> LIMB_BITS);
+        carry = (static_cast<u128>(w2) << 64) | w1;
+    }
+}
+
+} // namespace limbs
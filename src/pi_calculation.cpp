@@ -1,33 +1,373 @@
 #include "../include/long_arithmetic.hpp"
 #include "../include/pi_calculation.hpp"
+#include "../include/static_fixed_point.hpp"
+#include "../include/task_pool.hpp"
+#include "../include/checkpoint.hpp"
+#include "../include/limb_pool.hpp"
+#include "../include/serialization.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <vector>
 
 void CalcPi(FixedPoint &pi, const int k_start, const int k_finish, const FixedPoint &bs) {
-    FixedPoint one = FixedPoint(1.0, 256);
-    FixedPoint two = FixedPoint(2.0, 256);
-    FixedPoint four = FixedPoint(4.0, 256);
-    FixedPoint base = bs;
-    FixedPoint res = FixedPoint(0.0, 256);
+    // The series runs at 512 fractional bits as before, in fixed-width limbs
+    using Fixed = StaticFixedPoint<1, 16>;
+    // 1 / base, which only shrinks by 16 from one term to the next
+    Fixed scale(FixedPoint(1, 512) / bs);
+    Fixed res;
     for(int i = k_start; i < k_finish; ++i) {
-        res = res + ((four / FixedPoint(8 * i + 1, 256)) -
-                     (two / FixedPoint(8 * i + 4, 256)) -
-                     (one / FixedPoint(8 * i + 5, 256)) -
-                     (one / FixedPoint(8 * i + 6, 256))) / base;
-        base = base * FixedPoint(16.0, 256);
+        res += (scale << 2) / (8u * i + 1) -
+               (scale << 1) / (8u * i + 4) -
+               scale / (8u * i + 5) -
+               scale / (8u * i + 6);
+        scale >>= 4;
     }
-    pi = pi + res;
+    pi = pi + FixedPoint(res);
 }
 
-FixedPoint get_pi() {
-    int prec = 86;
-    int n = (prec + 15) / 16 * 16;
-    int signs = n / 16;
-    FixedPoint pi = FixedPoint(0.0, 256);
-    FixedPoint curBs = FixedPoint(1.0, 256);
+namespace {
+
+// Products over the terms [a, b) of the Chudnovsky series, kept as exact integers:
+// p = prod p(k), q = prod q(k), t = sum of the terms scaled by the common denominator
+struct Series {
+    FixedPoint p, q, t;
+};
+
+// 640320^3 / 24, the constant part of q(k) = k^3 * 640320^3 / 24
+const FixedPoint C3_OVER_24 = FixedPoint(static_cast<uint64_t>(10939058860032000ull), 0);
+
+// Subtrees with fewer terms are evaluated by one worker, larger ones fork their halves
+const uint64_t PARALLEL_TERMS = 64;
+
+// From this many terms the multiplications of a merge also run in parallel
+const uint64_t PARALLEL_MERGE_TERMS = 4096;
+
+// Combines the products of two neighbouring ranges covering `terms` terms in total:
+// p = p_left * p_right, q = q_left * q_right, t = t_left * q_right + p_left * t_right
+Series merge(const Series &left, const Series &right, uint64_t terms, TaskPool &pool, bool need_p) {
+    FixedPoint p(0, 0), q(0, 0), t_left(0, 0), t_right(0, 0);
+    auto mul_p = [&] { if (need_p) p = left.p * right.p; };
+    auto mul_q = [&] { q = left.q * right.q; };
+    auto mul_t_left = [&] { t_left = left.t * right.q; };
+    auto mul_t_right = [&] { t_right = left.p * right.t; };
+    if (terms >= PARALLEL_MERGE_TERMS) {
+        pool.fork_join([&] { pool.fork_join(mul_p, mul_q); }, [&] { pool.fork_join(mul_t_left, mul_t_right); });
+    } else {
+        mul_p();
+        mul_q();
+        mul_t_left();
+        mul_t_right();
+    }
+    return {std::move(p), std::move(q), std::move(t_left) + t_right};
+}
+
+// The tree shape and every operation are fixed by [a, b), so the result does not depend
+// on which worker evaluates which node. need_p is false for the root, whose P is unused.
+Series split(uint64_t a, uint64_t b, TaskPool &pool, bool need_p = true) {
+    if (b - a == 1) {
+        if (a == 0) {
+            return {FixedPoint(1, 0), FixedPoint(1, 0), FixedPoint(13591409, 0)};
+        }
+        // p(a) = (6a - 5)(2a - 1)(6a - 1), q(a) = a^3 * 640320^3 / 24
+        FixedPoint p = FixedPoint(6 * a - 5, 0) * static_cast<uint32_t>(2 * a - 1) * static_cast<uint32_t>(6 * a - 1);
+        FixedPoint q = FixedPoint(a, 0) * static_cast<uint32_t>(a) * static_cast<uint32_t>(a) * C3_OVER_24;
+        FixedPoint t = p * FixedPoint(13591409 + 545140134 * a, 0);
+        if (a & 1) {
+            t = FixedPoint(0, 0) - t;
+        }
+        return {std::move(p), std::move(q), std::move(t)};
+    }
+
+    uint64_t m = (a + b) / 2;
+    Series left = {FixedPoint(0, 0), FixedPoint(0, 0), FixedPoint(0, 0)};
+    Series right = left;
+    if (b - a >= PARALLEL_TERMS) {
+        pool.fork_join([&] { left = split(a, m, pool); }, [&] { right = split(m, b, pool); });
+    } else {
+        left = split(a, m, pool);
+        right = split(m, b, pool);
+    }
+
+    return merge(left, right, b - a, pool, need_p);
+}
+
+// A finished range of terms on the binary-splitting stack. Entries are never modified
+// once pushed, so checkpoint snapshots share them instead of copying the numbers.
+struct Range {
+    uint64_t a, b;
+    std::shared_ptr<const Series> series;
+};
+
+const char CHECKPOINT_MAGIC[8] = {'P', 'I', 'C', 'K', 'P', 'T', '0', '2'};
+
+// Blocks of terms evaluated between two checkpoints: about 64 per run, a power of two
+// so that the stack merges them into a balanced tree
+uint64_t checkpoint_block(uint64_t terms) {
+    uint64_t block = 256;
+    while (block * 64 < terms) block *= 2;
+    return block;
+}
+
+// The header and range bounds are little-endian 64-bit words, like the FixedPoint
+// images between them
+void write_words(std::ostream &out, std::initializer_list<uint64_t> words) {
+    for (uint64_t word : words) {
+        unsigned char bytes[8];
+        store_le(bytes, word, sizeof bytes);
+        out.write(reinterpret_cast<const char *>(bytes), sizeof bytes);
+    }
+}
 
-    for (int i = 0; i <= n; i++) {
-        if (i % signs == 0)
-            CalcPi(pi, i, i + signs, curBs);
-        curBs = curBs * FixedPoint(16.0, 256);
+void read_words(std::istream &in, uint64_t *words, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        unsigned char bytes[8];
+        in.read(reinterpret_cast<char *>(bytes), sizeof bytes);
+        words[i] = load_le(bytes, sizeof bytes);
     }
+}
+
+void save_state(std::ostream &out, uint64_t digits, uint64_t terms, const std::vector<Range> &stack) {
+    out.write(CHECKPOINT_MAGIC, sizeof CHECKPOINT_MAGIC);
+    write_words(out, {digits, terms, stack.size()});
+    for (const Range &range : stack) {
+        write_words(out, {range.a, range.b});
+        range.series->p.write_binary(out);
+        range.series->q.write_binary(out);
+        range.series->t.write_binary(out);
+    }
+}
+
+// Returns an empty stack when there is no checkpoint yet
+std::vector<Range> load_state(const std::string &path, uint64_t digits, uint64_t terms) {
+    std::vector<Range> stack;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return stack;
+
+    char magic[sizeof CHECKPOINT_MAGIC];
+    uint64_t header[3];
+    in.read(magic, sizeof magic);
+    read_words(in, header, 3);
+    if (!in || !std::equal(magic, magic + sizeof magic, CHECKPOINT_MAGIC)) {
+        throw std::runtime_error("Not a pi checkpoint: " + path);
+    }
+    if (header[0] != digits || header[1] != terms) {
+        throw std::runtime_error("Checkpoint " + path + " was made for " + std::to_string(header[0]) + " digits");
+    }
+
+    // The ranges have to cover [0, b) of this run's terms left to right, anything else
+    // would silently give wrong digits
+    for (uint64_t i = 0; i < header[2]; i++) {
+        uint64_t bounds[2];
+        read_words(in, bounds, 2);
+        if (!in) throw std::runtime_error("Truncated checkpoint " + path);
+        uint64_t expected = stack.empty() ? 0 : stack.back().b;
+        if (bounds[0] != expected || bounds[1] <= bounds[0] || bounds[1] > terms) {
+            throw std::runtime_error("Corrupt checkpoint " + path + ": range [" + std::to_string(bounds[0]) + ", " +
+                                     std::to_string(bounds[1]) + ") does not continue the terms");
+        }
+        FixedPoint p = FixedPoint::read_binary(in);
+        FixedPoint q = FixedPoint::read_binary(in);
+        FixedPoint t = FixedPoint::read_binary(in);
+        stack.push_back({bounds[0], bounds[1], std::make_shared<const Series>(Series{std::move(p), std::move(q), std::move(t)})});
+    }
+    return stack;
+}
+
+// Evaluates at most max_blocks blocks of terms after the ranges on the stack, from left
+// to right. Two neighbours of equal length on the stack are merged at once, like the
+// carries of a binary counter. After every block the stack goes to the checkpoint writer.
+void run_blocks(std::vector<Range> &stack, uint64_t digits, uint64_t terms, uint64_t max_blocks, TaskPool &pool,
+                CheckpointWriter &writer) {
+    uint64_t block = checkpoint_block(terms);
+    for (uint64_t next = stack.empty() ? 0 : stack.back().b; next < terms && max_blocks > 0; max_blocks--) {
+        uint64_t end = std::min(terms, next + block);
+        stack.push_back({next, end, std::make_shared<const Series>(split(next, end, pool))});
+        next = end;
+
+        while (stack.size() >= 2 && stack[stack.size() - 1].b - stack[stack.size() - 1].a ==
+                                        stack[stack.size() - 2].b - stack[stack.size() - 2].a) {
+            Range right = std::move(stack.back());
+            stack.pop_back();
+            Range left = std::move(stack.back());
+            stack.pop_back();
+            stack.push_back({left.a, right.b, std::make_shared<const Series>(
+                merge(*left.series, *right.series, right.b - left.a, pool, true))});
+        }
+
+        // Copies only the shared pointers, the numbers are serialized in the background
+        writer.submit([stack, digits, terms](std::ostream &out) { save_state(out, digits, terms, stack); });
+    }
+    writer.flush();
+}
+
+// Same P, Q, T as split(0, terms), evaluated by run_blocks
+Series split_checkpointed(uint64_t digits, uint64_t terms, TaskPool &pool, CheckpointWriter &writer, bool resume) {
+    std::vector<Range> stack;
+    if (resume) stack = load_state(writer.path(), digits, terms);
+    run_blocks(stack, digits, terms, UINT64_MAX, pool, writer);
+
+    // Fold what is left on the stack from the right. A merge only reads the P of its left
+    // part and every merged range becomes a right part, so no merged P is ever needed
+    while (stack.size() > 1) {
+        Range right = std::move(stack.back());
+        stack.pop_back();
+        Range left = std::move(stack.back());
+        stack.pop_back();
+        stack.push_back({left.a, right.b, std::make_shared<const Series>(
+            merge(*left.series, *right.series, right.b - left.a, pool, false))});
+    }
+    return *stack.front().series;
+}
+
+__extension__ typedef unsigned __int128 u128; // -pedantic knows no 128-bit integers
+
+// 16^e mod d by square-and-multiply, in 64-bit arithmetic while d fits into 32 bits
+uint64_t pow16_mod(uint64_t e, uint64_t d) {
+    uint64_t result = 1 % d, base = 16 % d;
+    if (d >> 32 == 0) {
+        for (; e > 0; e >>= 1) {
+            if (e & 1) result = result * base % d;
+            base = base * base % d;
+        }
+        return result;
+    }
+    for (; e > 0; e >>= 1) {
+        if (e & 1) result = static_cast<uint64_t>(static_cast<u128>(result) * base % d);
+        base = static_cast<uint64_t>(static_cast<u128>(base) * base % d);
+    }
+    return result;
+}
+
+// frac(sum over k in [a, b) of 16^(n - k) / (8k + j)) in units of 2^-64, for k <= n.
+// Every term is truncated to 64 bits, the wrapping additions drop the integer parts.
+uint64_t bbp_head(uint64_t n, unsigned j, uint64_t a, uint64_t b) {
+    uint64_t sum = 0;
+    for (uint64_t k = a; k < b; k++) {
+        uint64_t d = 8 * k + j;
+        sum += static_cast<uint64_t>((static_cast<u128>(pow16_mod(n - k, d)) << 64) / d);
+    }
+    return sum;
+}
+
+// 4 S1 - 2 S4 - S5 - S6 over the terms [a, b) of the head, forking large ranges
+const uint64_t BBP_BLOCK = 1 << 14;
+
+uint64_t bbp_block(uint64_t n, uint64_t a, uint64_t b, TaskPool &pool) {
+    if (b - a <= BBP_BLOCK) {
+        return 4 * bbp_head(n, 1, a, b) - 2 * bbp_head(n, 4, a, b) - bbp_head(n, 5, a, b) - bbp_head(n, 6, a, b);
+    }
+    uint64_t m = a + (b - a) / 2, left = 0, right = 0;
+    pool.fork_join([&] { left = bbp_block(n, a, m, pool); }, [&] { right = bbp_block(n, m, b, pool); });
+    return left + right;
+}
+
+// frac(16^n * pi) in units of 2^-64 with an error of a few (n + 16) ulps
+uint64_t bbp_fraction(uint64_t n, TaskPool &pool) {
+    uint64_t sum = bbp_block(n, 0, n + 1, pool);
+
+    // The tail k > n: 16^(n - k) / (8k + j) vanishes below 2^-64 after 16 terms
+    for (uint64_t k = n + 1; k <= n + 16; k++) {
+        u128 scaled = static_cast<u128>(1) << (64 - 4 * (k - n));
+        sum += static_cast<uint64_t>(4 * (scaled / (8 * k + 1)) - 2 * (scaled / (8 * k + 4)) - scaled / (8 * k + 5) - scaled / (8 * k + 6));
+    }
+    return sum;
+}
+
+} // namespace
+
+namespace {
+
+// Every term of the series adds log10(640320^3 / 1728) = 14.18 digits
+uint64_t series_terms(size_t digits) {
+    return digits / 14 + 2;
+}
+
+// pi = 426880 * sqrt(10005) * Q / T, the square root is computed next to the series.
+// The temporaries of both come from arena, the result is allocated outside of it.
+FixedPoint chudnovsky(size_t digits, unsigned threads, LimbPool &arena, CheckpointWriter *writer, bool resume) {
+    uint64_t terms = series_terms(digits);
+
+    // to_string prints 8 digits per fractional limb, the last limb is a guard
+    size_t frac_bits = 32 * (digits / 8 + 2);
+
+    TaskPool pool(threads);
+    Series series = {FixedPoint(0, 0), FixedPoint(0, 0), FixedPoint(0, 0)};
+    FixedPoint root(0, 0);
+    {
+        ScopedLimbAllocator scope(&arena);
+        pool.run([&] {
+            pool.fork_join([&] {
+                series = writer ? split_checkpointed(digits, terms, pool, *writer, resume) : split(0, terms, pool, false);
+            }, [&] { root = sqrt(FixedPoint(10005, 0), frac_bits + 32); });
+        });
+    }
+    FixedPoint numerator = root * 426880u * series.q;
+
+    // Q has many factors of two, the product may have shed low zero limbs
+    numerator.set_precision(frac_bits);
+    return numerator / series.t;
+}
+
+} // namespace
+
+FixedPoint get_pi(size_t digits, unsigned threads) {
+    LimbPool arena;
+    return chudnovsky(digits, threads, arena, nullptr, false);
+}
+
+FixedPoint get_pi(size_t digits, unsigned threads, const std::string &checkpoint_path, bool resume) {
+    // The arena outlives the writer, whose pending snapshot may still hold series values
+    LimbPool arena;
+    FixedPoint pi(0, 0);
+    {
+        CheckpointWriter writer(checkpoint_path);
+        pi = chudnovsky(digits, threads, arena, &writer, resume);
+    }
+    std::remove(checkpoint_path.c_str());
     return pi;
-}
\ No newline at end of file
+}
+
+bool advance_pi_checkpoint(size_t digits, unsigned threads, const std::string &checkpoint_path, uint64_t blocks) {
+    uint64_t terms = series_terms(digits);
+    LimbPool arena;
+    TaskPool pool(threads);
+    CheckpointWriter writer(checkpoint_path);
+    bool complete = false;
+    {
+        ScopedLimbAllocator scope(&arena);
+        pool.run([&] {
+            std::vector<Range> stack = load_state(checkpoint_path, digits, terms);
+            run_blocks(stack, digits, terms, blocks, pool, writer);
+            complete = !stack.empty() && stack.back().b == terms;
+        });
+    }
+    return complete;
+}
+
+std::string pi_hex_digits(uint64_t position, size_t count, unsigned threads) {
+    static const char hex[] = "0123456789ABCDEF";
+    TaskPool pool(threads);
+    std::string digits;
+
+    pool.run([&] {
+        while (digits.size() < count) {
+            uint64_t n = position + digits.size();
+
+            // Every term may be off by one ulp in each of the four sums: keep the hex
+            // digits above 4 * (n + 17) ulps plus a few guard bits
+            unsigned error_bits = 64 - __builtin_clzll(4 * (n + 17)) + 4;
+            size_t reliable = std::max(1u, (64 - error_bits) / 4);
+
+            uint64_t fraction = bbp_fraction(n, pool);
+            for (size_t i = 0; i < reliable && digits.size() < count; i++) {
+                digits.push_back(hex[(fraction >> (60 - 4 * i)) & 0xF]);
+            }
+        }
+    });
+    return digits;
+}
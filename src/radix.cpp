@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../include/limbs.hpp"
+
+namespace limbs {
+
+namespace {
+
+constexpr limb_t CHUNK = 1000000000; // 10^9, the largest power of ten in a limb
+constexpr size_t CHUNK_DIGITS = 9;
+
+// One level of the divide-and-conquer tree: 10^digits with digits = 9 * 2^k
+struct Power {
+    std::vector<limb_t> value;
+    size_t digits;
+    std::optional<Reciprocal> inverse; // Only for powers long enough for Newton division
+
+    Power(std::vector<limb_t> &&v, size_t d, bool divisor) : value(std::move(v)), digits(d) {
+        if (divisor && value.size() >= div_thresholds().newton) inverse.emplace(value.data(), value.size());
+    }
+};
+
+// 10^9, 10^18, 10^36, ... while the square of the last power still fits into n limbs.
+// Reciprocals are only prepared when the powers will be used as divisors.
+std::vector<Power> decimal_powers(size_t n, bool divisors) {
+    std::vector<Power> powers;
+    powers.emplace_back(std::vector<limb_t>{CHUNK}, CHUNK_DIGITS, divisors);
+
+    while (2 * powers.back().value.size() <= n) {
+        const std::vector<limb_t> &last = powers.back().value;
+        std::vector<limb_t> square(2 * last.size());
+        mul(square.data(), last.data(), last.size(), last.data(), last.size());
+        square.resize(normalized_size(square.data(), square.size()));
+        powers.emplace_back(std::move(square), 2 * powers.back().digits, divisors);
+    }
+    return powers;
+}
+
+// Receives the digits in order. Without a stream they pile up in buffer, with one they
+// are written out every time `chunk` of them have accumulated.
+struct DigitSink {
+    std::string buffer;
+    std::ostream *stream = nullptr;
+    size_t chunk = 0;
+    size_t written = 0;
+
+    void append(const std::string &digits) {
+        buffer += digits;
+        spill();
+    }
+
+    void append(size_t count, char c) {
+        while (count > 0) {
+            size_t step = stream ? std::min(count, chunk) : count;
+            buffer.append(step, c);
+            count -= step;
+            spill();
+        }
+    }
+
+    void spill() {
+        if (stream && buffer.size() >= chunk) flush();
+    }
+
+    void flush() {
+        stream->write(buffer.data(), buffer.size());
+        written += buffer.size();
+        buffer.clear();
+    }
+};
+
+// Appends the digits of a[0 .. an) to out, left-padded with zeros to width digits
+// (a < 10^width is guaranteed). Quadratic: one pass of divmod_1 per 9 digits.
+void to_decimal_basecase(const limb_t *a, size_t an, size_t width, DigitSink &out) {
+    std::vector<limb_t> cur(a, a + an);
+    std::vector<limb_t> chunks;
+    while (!cur.empty()) {
+        chunks.push_back(divmod_1(cur.data(), cur.data(), cur.size(), CHUNK));
+        cur.resize(normalized_size(cur.data(), cur.size()));
+    }
+
+    std::string digits;
+    for (size_t i = chunks.size(); i-- > 0;) {
+        std::string chunk = std::to_string(chunks[i]);
+        if (i + 1 < chunks.size()) digits.append(CHUNK_DIGITS - chunk.size(), '0');
+        digits += chunk;
+    }
+
+    if (digits.size() < width) out.append(width - digits.size(), '0');
+    out.append(digits);
+}
+
+// Splits a by the largest power of about half its length: the quotient gives the
+// leading digits and the remainder exactly powers[k].digits trailing ones. a is freed
+// before the recursion, so at most one pending remainder per level stays alive.
+void to_decimal_rec(std::vector<limb_t> a, size_t width, const std::vector<Power> &powers, DigitSink &out) {
+    size_t an = normalized_size(a.data(), a.size());
+    if (an < radix_thresholds().divide_conquer) {
+        to_decimal_basecase(a.data(), an, width, out);
+        return;
+    }
+
+    size_t k = powers.size() - 1;
+    while (k > 0 && 2 * powers[k].value.size() > an + 1) k--;
+    const Power &power = powers[k];
+    size_t n = power.value.size();
+
+    std::vector<limb_t> q(an - n + 1, 0), r(n, 0);
+    if (power.inverse) {
+        divmod(q.data(), r.data(), a.data(), an, *power.inverse);
+    } else {
+        divmod_basecase(q.data(), r.data(), a.data(), an, power.value.data(), n);
+    }
+    a = std::vector<limb_t>();
+
+    to_decimal_rec(std::move(q), width > power.digits ? width - power.digits : 0, powers, out);
+    to_decimal_rec(std::move(r), power.digits, powers, out);
+}
+
+// Shared by to_decimal and write_decimal, zero without padding gives "0"
+void to_decimal_sink(const limb_t *a, size_t n, size_t width, DigitSink &out) {
+    n = normalized_size(a, n);
+    if (n < radix_thresholds().divide_conquer) {
+        to_decimal_basecase(a, n, width, out);
+    } else {
+        to_decimal_rec(std::vector<limb_t>(a, a + n), width, decimal_powers(n, true), out);
+    }
+
+    if (out.buffer.empty() && out.written == 0) out.append("0");
+}
+
+// r[0 .. len / 9 + 1) = value of digits[0 .. len) accumulated 9 digits at a time.
+// Quadratic: one pass of mul_1 per chunk.
+void from_decimal_basecase(const char *digits, size_t len, limb_t *r, size_t rn) {
+    std::fill(r, r + rn, 0);
+    size_t n = 0;
+    for (size_t pos = 0; pos < len;) {
+        size_t step = std::min(CHUNK_DIGITS, len - pos);
+        limb_t chunk = 0, scale = 1;
+        for (size_t i = 0; i < step; i++, pos++) {
+            chunk = chunk * 10 + static_cast<limb_t>(digits[pos] - '0');
+            scale *= 10;
+        }
+
+        limb_t carry = mul_1(r, r, n, scale, chunk);
+        if (carry) r[n++] = carry;
+    }
+}
+
+// Splits the digits in front of the last powers[k].digits ones and combines the two
+// halves as high * 10^digits + low
+void from_decimal_rec(const char *digits, size_t len, const std::vector<Power> &powers, limb_t *r, size_t rn) {
+    if (len / CHUNK_DIGITS < radix_thresholds().divide_conquer) {
+        from_decimal_basecase(digits, len, r, rn);
+        return;
+    }
+
+    size_t k = powers.size() - 1;
+    while (k > 0 && 2 * powers[k].digits >= len) k--;
+    const Power &power = powers[k];
+    size_t high_len = len - power.digits;
+
+    std::vector<limb_t> high(high_len / CHUNK_DIGITS + 1), low(power.digits / CHUNK_DIGITS + 1);
+    from_decimal_rec(digits, high_len, powers, high.data(), high.size());
+    from_decimal_rec(digits + high_len, power.digits, powers, low.data(), low.size());
+
+    size_t hn = normalized_size(high.data(), high.size());
+    size_t ln = normalized_size(low.data(), low.size());
+    size_t pn = power.value.size();
+
+    // The product buffer may be a limb or two longer than r, the value itself fits
+    std::vector<limb_t> sum(pn + hn, 0);
+    if (hn != 0) mul(sum.data(), power.value.data(), pn, high.data(), hn);
+    add(sum.data(), sum.data(), sum.size(), low.data(), ln);
+
+    std::fill(r, r + rn, 0);
+    std::copy(sum.begin(), sum.begin() + std::min(rn, sum.size()), r);
+}
+
+} // namespace
+
+RadixThresholds &radix_thresholds() {
+    static RadixThresholds thresholds;
+    return thresholds;
+}
+
+std::vector<limb_t> pow_1(limb_t base, size_t exp) {
+    std::vector<limb_t> result{1}, square{base};
+    for (; exp > 0; exp >>= 1) {
+        if (exp & 1) {
+            std::vector<limb_t> product(result.size() + square.size());
+            mul(product.data(), result.data(), result.size(), square.data(), square.size());
+            product.resize(normalized_size(product.data(), product.size()));
+            result = std::move(product);
+        }
+        if (exp > 1) {
+            std::vector<limb_t> product(2 * square.size());
+            mul(product.data(), square.data(), square.size(), square.data(), square.size());
+            product.resize(normalized_size(product.data(), product.size()));
+            square = std::move(product);
+        }
+    }
+    return result;
+}
+
+std::string to_decimal(const limb_t *a, size_t n, size_t width) {
+    DigitSink out;
+    to_decimal_sink(a, n, width, out);
+    return std::move(out.buffer);
+}
+
+void write_decimal(std::ostream &stream, const limb_t *a, size_t n, size_t width, size_t chunk) {
+    DigitSink out;
+    out.stream = &stream;
+    out.chunk = std::max<size_t>(chunk, 1);
+    to_decimal_sink(a, n, width, out);
+    out.flush();
+}
+
+std::vector<limb_t> from_decimal(const char *digits, size_t len) {
+    // 10^9 < 2^30, so every 9 digits need less than one limb
+    std::vector<limb_t> r(len / CHUNK_DIGITS + 1);
+    if (len / CHUNK_DIGITS < radix_thresholds().divide_conquer) {
+        from_decimal_basecase(digits, len, r.data(), r.size());
+    } else {
+        from_decimal_rec(digits, len, decimal_powers(len / CHUNK_DIGITS + 1, false), r.data(), r.size());
+    }
+
+    r.resize(normalized_size(r.data(), r.size()));
+    return r;
+}
+
+} // namespace limbs
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/serialization.hpp"
+
+void store_le(unsigned char *dst, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        dst[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+uint64_t load_le(const unsigned char *src, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= uint64_t(src[i]) << (8 * i);
+    }
+    return value;
+}
+
+namespace {
+
+const char SERIAL_MAGIC[4] = {'F', 'X', 'P', 'T'};
+constexpr bool HOST_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+// Limb counts above this are rejected as corrupt, it keeps their sums from overflowing.
+// Smaller counts are not trusted either: read_binary allocates only as the limbs arrive.
+constexpr uint64_t MAX_LIMBS = uint64_t(1) << 40;
+
+// First chunk of limbs read from a stream, later chunks double
+constexpr uint64_t READ_CHUNK_LIMBS = uint64_t(1) << 16;
+
+struct Header {
+    bool negative;
+    uint32_t frac_bits;
+    uint64_t frac_sz;
+    uint64_t int_sz;
+};
+
+void encode_header(unsigned char *dst, const Header &header) {
+    std::memcpy(dst, SERIAL_MAGIC, sizeof SERIAL_MAGIC);
+    store_le(dst + 4, SERIAL_VERSION, 2);
+    store_le(dst + 6, 32, 1);
+    store_le(dst + 7, header.negative, 1);
+    store_le(dst + 8, header.frac_bits, 4);
+    store_le(dst + 12, 0, 4);
+    store_le(dst + 16, header.frac_sz, 8);
+    store_le(dst + 24, header.int_sz, 8);
+}
+
+Header decode_header(const unsigned char *src) {
+    if (std::memcmp(src, SERIAL_MAGIC, sizeof SERIAL_MAGIC) != 0) {
+        throw std::runtime_error("Not a FixedPoint image");
+    }
+    uint64_t version = load_le(src + 4, 2);
+    if (version != SERIAL_VERSION) {
+        throw std::runtime_error("Unsupported FixedPoint image version " + std::to_string(version));
+    }
+    uint64_t flags = load_le(src + 7, 1);
+    Header header{(flags & 1) != 0, uint32_t(load_le(src + 8, 4)), load_le(src + 16, 8), load_le(src + 24, 8)};
+    if (load_le(src + 6, 1) != 32 || (flags & ~uint64_t(1)) != 0 || load_le(src + 12, 4) != 0 ||
+        header.frac_sz > MAX_LIMBS || header.int_sz > MAX_LIMBS) {
+        throw std::runtime_error("Malformed FixedPoint image");
+    }
+    // fractional_bits ends in the last fractional limb, as normalize() and set_precision() keep it
+    if (header.frac_bits > 32 * header.frac_sz || (header.frac_sz != 0 && header.frac_bits <= 32 * (header.frac_sz - 1))) {
+        throw std::runtime_error("Malformed FixedPoint image: " + std::to_string(header.frac_bits) +
+                                 " fractional bits in " + std::to_string(header.frac_sz) + " limbs");
+    }
+    return header;
+}
+
+// Limbs padded to a multiple of two, the size of an image body
+uint64_t padded_limbs(const Header &header) {
+    return (header.frac_sz + header.int_sz + 1) / 2 * 2;
+}
+
+void write_limbs(std::ostream &out, const LimbVector &limbs) {
+    if (HOST_LITTLE_ENDIAN) {
+        out.write(reinterpret_cast<const char *>(limbs.data()), limbs.size() * sizeof(uint32_t));
+        return;
+    }
+    for (uint32_t limb : limbs) {
+        unsigned char bytes[4];
+        store_le(bytes, limb, 4);
+        out.write(reinterpret_cast<const char *>(bytes), sizeof bytes);
+    }
+}
+
+// Reads count limbs in chunks that grow with the limbs already read, so a corrupt count
+// ends in a failed stream after at most twice the data it really holds is allocated
+void read_limbs(std::istream &in, LimbVector &limbs, uint64_t count) {
+    limbs.clear();
+    while (limbs.size() < count && in) {
+        size_t done = limbs.size();
+        size_t chunk = std::min(count - done, std::max<uint64_t>(READ_CHUNK_LIMBS, done));
+        limbs.resize(done + chunk);
+        in.read(reinterpret_cast<char *>(limbs.data() + done), chunk * sizeof(uint32_t));
+    }
+    if (!HOST_LITTLE_ENDIAN) {
+        for (uint32_t &limb : limbs) {
+            limb = uint32_t(load_le(reinterpret_cast<const unsigned char *>(&limb), 4));
+        }
+    }
+}
+
+// The view of a freshly mapped file, the mapping is released if the image is rejected
+FixedPointView view_or_unmap(const void *data, size_t size) {
+    try {
+        return FixedPointView(data, size);
+    } catch (...) {
+        munmap(const_cast<void *>(data), size);
+        throw;
+    }
+}
+
+} // namespace
+
+void FixedPoint::write_binary(std::ostream &out) const {
+    Header header{is_negative, fractional_bits, frac_limbs, int_limbs()};
+    unsigned char bytes[SERIAL_HEADER_SIZE];
+    encode_header(bytes, header);
+    out.write(reinterpret_cast<const char *>(bytes), sizeof bytes);
+    write_limbs(out, limb);
+    if (padded_limbs(header) != header.frac_sz + header.int_sz) {
+        const char pad[4] = {};
+        out.write(pad, sizeof pad);
+    }
+}
+
+FixedPoint FixedPoint::read_binary(std::istream &in) {
+    unsigned char bytes[SERIAL_HEADER_SIZE];
+    in.read(reinterpret_cast<char *>(bytes), sizeof bytes);
+    if (!in) {
+        throw std::runtime_error("Truncated FixedPoint image");
+    }
+    Header header = decode_header(bytes);
+
+    FixedPoint result(0, 0);
+    result.is_negative = header.negative;
+    result.fractional_bits = header.frac_bits;
+    result.frac_limbs = header.frac_sz;
+    read_limbs(in, result.limb, header.frac_sz + header.int_sz);
+    if (padded_limbs(header) != header.frac_sz + header.int_sz) {
+        char pad[4];
+        in.read(pad, sizeof pad);
+    }
+    if (!in) {
+        throw std::runtime_error("Truncated FixedPoint image");
+    }
+    result.trim_integer();
+    return result;
+}
+
+FixedPointView::FixedPointView(const void *data, size_t size) {
+    if (!HOST_LITTLE_ENDIAN) {
+        throw std::runtime_error("FixedPoint images can only be viewed in place on little-endian hosts");
+    }
+    if (size < SERIAL_HEADER_SIZE) {
+        throw std::runtime_error("Truncated FixedPoint image");
+    }
+    if (reinterpret_cast<uintptr_t>(data) % alignof(uint32_t) != 0) {
+        throw std::runtime_error("Misaligned FixedPoint image");
+    }
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    Header header = decode_header(bytes);
+    if ((size - SERIAL_HEADER_SIZE) / sizeof(uint32_t) < header.frac_sz + header.int_sz) {
+        throw std::runtime_error("Truncated FixedPoint image");
+    }
+
+    limbs = reinterpret_cast<const uint32_t *>(bytes + SERIAL_HEADER_SIZE);
+    negative = header.negative;
+    frac_bits = header.frac_bits;
+    frac_sz = header.frac_sz;
+    int_sz = header.int_sz;
+}
+
+FixedPoint FixedPointView::to_fixed_point() const {
+    FixedPoint result(0, 0);
+    result.is_negative = negative;
+    result.fractional_bits = frac_bits;
+    result.frac_limbs = frac_sz;
+    result.limb.assign(limbs, limbs + frac_sz + int_sz);
+    result.trim_integer();
+    return result;
+}
+
+MappedFixedPoint::MappedFixedPoint(const std::string &path)
+    : data(map(path, size)), image(view_or_unmap(data, size)) {}
+
+MappedFixedPoint::~MappedFixedPoint() {
+    munmap(const_cast<void *>(data), size);
+}
+
+const void *MappedFixedPoint::map(const std::string &path, size_t &size) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        throw std::runtime_error("Cannot map empty file " + path);
+    }
+    size = static_cast<size_t>(info.st_size);
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path);
+    }
+    return data;
+}
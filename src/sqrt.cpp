@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "../include/long_arithmetic.hpp"
+
+// Square roots through Newton's iteration for the inverse square root,
+// y += y * (1 - x * y^2) / 2, which needs no division. Each step doubles the correct
+// bits, so it runs at a working precision that doubles from the double seed up to the
+// target and the earlier steps together cost about as much as the last one.
+
+namespace {
+
+// Bits computed past the requested precision. With an error far below them the
+// truncated result is decided by the approximation alone unless it lies next to a
+// multiple of the last bit, which an exact check then settles.
+constexpr int64_t GUARD_BITS = 64;
+
+// The double seed is good to this many bits
+constexpr size_t SEED_BITS = 48;
+
+// 1 / sqrt(x) for x in [1, 2^64) with a relative error below 2^-bits, starting from
+// the double estimate seed. y stays in (2^-32, 1] and x * y^2 close to 1, so every
+// truncation keeps 48 bits more than the step needs after that scale.
+FixedPoint rsqrt_newton(const FixedPoint &x, double seed, size_t bits) {
+    std::vector<size_t> steps;
+    for (size_t b = bits; b > SEED_BITS; b = b / 2 + 1) {
+        steps.push_back(b + 48);
+    }
+
+    FixedPoint y(seed, 128);
+    const FixedPoint one(1, 0);
+    for (size_t i = steps.size(); i-- > 0;) {
+        size_t w = steps[i];
+        FixedPoint xw = x;
+        xw.set_precision(w);
+
+        FixedPoint t = y * y;
+        t.set_precision(w + 64);
+        t = xw * t;
+        t.set_precision(w);
+
+        FixedPoint correction = y * (one - t);
+        correction.set_precision(w + 32);
+        y += correction >> 1;
+        y.set_precision(w + 32);
+    }
+    return y;
+}
+
+} // namespace
+
+FixedPoint FixedPoint::square_root(const FixedPoint &x, size_t precision, bool inverse) {
+    if (x.is_zero()) {
+        if (inverse) {
+            throw std::runtime_error("Inverse square root of zero");
+        }
+        FixedPoint zero(0, 0);
+        zero.set_precision(precision);
+        return zero;
+    }
+    if (x.is_negative) {
+        throw std::runtime_error("Square root of a negative number");
+    }
+
+    // x = x' * 2^(64m) with x' in [1, 2^64): moving the radix point by 2m limbs is exact,
+    // and the roots of x are those of x' moved back by m limbs
+    size_t top = limbs::normalized_size(x.limb.data(), x.limb.size()) - 1;
+    int64_t log2 = 32 * (static_cast<int64_t>(top) - static_cast<int64_t>(x.frac_limbs)) + 31 -
+                   __builtin_clz(x.limb[top]);
+    int64_t m = log2 >= 0 ? log2 / 64 : -((63 - log2) / 64);
+    FixedPoint xn = ldexp(x, -64 * m);
+
+    double xd = 0;
+    for (size_t i = xn.limb.size(); i-- > 0 && i + 3 >= xn.limb.size();) {
+        xd += std::ldexp(xn.limb[i], 32 * (static_cast<int>(i) - static_cast<int>(xn.frac_limbs)));
+    }
+    double seed = 1 / std::sqrt(xd);
+
+    // Relative precision of the root of x' that leaves GUARD_BITS bits past precision
+    // after moving it back: 1 / sqrt(x') lies in (2^-32, 1], sqrt(x') in [1, 2^32)
+    int64_t target = inverse ? static_cast<int64_t>(precision) + GUARD_BITS - 32 * m
+                             : static_cast<int64_t>(precision) + GUARD_BITS + 32 + 32 * m;
+    size_t bits = static_cast<size_t>(std::max<int64_t>(target, 64));
+
+    FixedPoint result(0, 0);
+    if (inverse) {
+        result = ldexp(rsqrt_newton(xn, seed, bits), -32 * m);
+    } else {
+        // Karp's trick: s = x' * y at half the precision, then one correction
+        // s += y * (x' - s^2) / 2 doubles its bits with no full-precision iteration
+        size_t half = bits / 2 + 16;
+        FixedPoint y = rsqrt_newton(xn, seed, half);
+        FixedPoint s = xn * y;
+        s.set_precision(half + 8);
+
+        FixedPoint xw = xn;
+        xw.set_precision(bits + 32);
+        FixedPoint correction = y * (xw - s * s);
+        correction.set_precision(bits + 32);
+        s += correction >> 1;
+        s.set_precision(bits + 32);
+        result = ldexp(s, 32 * m);
+    }
+
+    // Bits precision + 1 .. precision + 32 of the approximation
+    result.set_precision(precision + 32);
+    size_t pos = 32 * result.frac_limbs - precision - 32;
+    uint64_t pair = result.limb[pos / 32] | (static_cast<uint64_t>(result.limb[pos / 32 + 1]) << 32);
+    uint32_t window = static_cast<uint32_t>(pair >> (pos % 32));
+    result.set_precision(precision);
+
+    // Next to a multiple of 2^-precision the truncation may have gone either way
+    if (window == 0 || window == UINT32_MAX) {
+        const FixedPoint one(1, 0);
+        FixedPoint step = ldexp(one, -static_cast<ptrdiff_t>(precision));
+        auto not_above = [&](const FixedPoint &c) {
+            FixedPoint square = c * c;
+            return inverse ? x * square <= one : square <= x;
+        };
+        FixedPoint up = result + step;
+        if (not_above(up)) {
+            result = up;
+        } else if (!not_above(result)) {
+            result -= step;
+        }
+        result.set_precision(precision);
+    }
+    return result;
+}
+
+FixedPoint sqrt(const FixedPoint &x, size_t precision) {
+    return FixedPoint::square_root(x, precision, false);
+}
+
+FixedPoint rsqrt(const FixedPoint &x, size_t precision) {
+    return FixedPoint::square_root(x, precision, true);
+}
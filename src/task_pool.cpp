@@ -0,0 +1,146 @@
+#include <chrono>
+
+#include "../include/task_pool.hpp"
+#include "../include/limb_vector.hpp"
+
+namespace {
+
+// Index of the worker running on this thread in its pool, the pool itself identifies
+// which pool the index belongs to
+thread_local const TaskPool *current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+} // namespace
+
+TaskPool::TaskPool(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (unsigned i = 0; i < threads; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back(&TaskPool::worker_loop, this, i);
+    }
+}
+
+TaskPool::~TaskPool() {
+    stopping = true;
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void TaskPool::run(const std::function<void()> &root) {
+    const TaskPool *saved_pool = current_pool;
+    size_t saved_index = current_index;
+    current_pool = this;
+    current_index = 0;
+    active = true;
+
+    try {
+        root();
+    } catch (...) {
+        active = false;
+        current_pool = saved_pool;
+        current_index = saved_index;
+        throw;
+    }
+
+    active = false;
+    current_pool = saved_pool;
+    current_index = saved_index;
+}
+
+void TaskPool::fork_join(const std::function<void()> &left, const std::function<void()> &right) {
+    if (current_pool != this || queues.size() == 1) {
+        left();
+        right();
+        return;
+    }
+
+    Queue &own = *queues[current_index];
+    Task task;
+    task.fn = &right;
+    task.allocator = LimbAllocator::current();
+    {
+        std::lock_guard<std::mutex> guard(own.lock);
+        own.tasks.push_back(&task);
+    }
+
+    std::exception_ptr left_error;
+    try {
+        left();
+    } catch (...) {
+        left_error = std::current_exception();
+    }
+
+    // Nested fork_joins inside left() have taken their tasks back, so right is still at
+    // the back of the deque unless another worker stole it
+    bool reclaimed = false;
+    {
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty() && own.tasks.back() == &task) {
+            own.tasks.pop_back();
+            reclaimed = true;
+        }
+    }
+
+    if (reclaimed) {
+        execute(&task);
+    } else {
+        // Help the others while the thief finishes
+        while (!task.done.load(std::memory_order_acquire)) {
+            if (Task *other = steal(current_index)) {
+                execute(other);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    if (left_error) std::rethrow_exception(left_error);
+    if (task.error) std::rethrow_exception(task.error);
+}
+
+void TaskPool::worker_loop(size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    size_t idle = 0;
+    while (!stopping) {
+        Task *task = active ? steal(index) : nullptr;
+        if (task) {
+            execute(task);
+            idle = 0;
+        } else if (++idle < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+}
+
+// Takes the oldest task of the first other worker that has one
+TaskPool::Task *TaskPool::steal(size_t thief) {
+    for (size_t i = 1; i < queues.size(); i++) {
+        Queue &victim = *queues[(thief + i) % queues.size()];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            Task *task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void TaskPool::execute(Task *task) {
+    ScopedLimbAllocator scope(task->allocator);
+    try {
+        (*task->fn)();
+    } catch (...) {
+        task->error = std::current_exception();
+    }
+    task->done.store(true, std::memory_order_release);
+}
@@ -1,9 +1,23 @@
 #include <gtest/gtest.h>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <vector>
+#include <random>
+#include <sstream>
 
 #include "../include/long_arithmetic.hpp"
 #include "../include/pi_calculation.hpp"
+#include "../include/limbs.hpp"
+#include "../include/task_pool.hpp"
+#include "../include/checkpoint.hpp"
+#include "../include/serialization.hpp"
+#include "../include/limb_pool.hpp"
+#include "../include/fixed_point_expr.hpp"
+#include "../include/static_fixed_point.hpp"
 
 // Test class for all operation tests
 class FixedPointTest: public ::testing::Test {
@@ -17,6 +31,28 @@ TEST_F(FixedPointTest, Constructor) {
     EXPECT_EQ(num.to_string(3), "123.456");
 }
 
+// Тест для конструкторов из double и целых чисел
+TEST_F(FixedPointTest, NativeConstructors) {
+    EXPECT_EQ(FixedPoint(42).to_string(), "42.0");
+    EXPECT_EQ(FixedPoint(-7, 64).to_string(), "-7.0");
+    EXPECT_EQ(FixedPoint(INT64_MIN).to_string(), "-9223372036854775808.0");
+    EXPECT_EQ(FixedPoint(UINT64_MAX, 0).to_string(), "18446744073709551615.0");
+    EXPECT_EQ(FixedPoint(4294967296u) + FixedPoint(1), FixedPoint("4294967297"));
+
+    // Doubles are converted exactly, not through six decimal places
+    EXPECT_EQ(FixedPoint(-2.75, 40).to_string(), FixedPoint("-2.75", 40).to_string());
+    EXPECT_EQ(FixedPoint(0.1, 64).to_string(), "0.1000000000000000");
+    EXPECT_EQ(FixedPoint(1e-7, 64).to_string(), "0.0000000999999999");
+    EXPECT_EQ(FixedPoint(1e20).to_string(), "100000000000000000000.0");
+    EXPECT_EQ(FixedPoint(1.5, 0).to_string(), "1.0");
+    EXPECT_EQ(FixedPoint(1e-300).to_string(), "0.0");
+    EXPECT_EQ(FixedPoint(-0.0).to_string(), "0.0");
+    EXPECT_EQ(FixedPoint(-1e-300).to_string(), "0.0");
+    EXPECT_EQ(FixedPoint(-0.25, 0).to_string(), "0.0");
+    EXPECT_EQ(FixedPoint(-0.0) + FixedPoint(1), FixedPoint(1));
+    EXPECT_THROW(FixedPoint(1.0 / 0.0), std::runtime_error);
+}
+
 // Тест для сложения
 TEST_F(FixedPointTest, Addition) {
     FixedPoint num1("10.5");
@@ -33,6 +69,154 @@ TEST_F(FixedPointTest, Subtraction) {
     EXPECT_EQ(result.to_string(), "30.75");
 }
 
+// Тест для составных операторов на месте и перемещения
+TEST_F(FixedPointTest, CompoundAssignment) {
+    FixedPoint num1("4294967296.5");
+    num1 -= FixedPoint("0.25", 96);
+    EXPECT_EQ(num1.to_string(), "4294967296.25");
+
+    FixedPoint num2("1.5");
+    num2 -= FixedPoint("2.75", 64);
+    EXPECT_EQ(num2.to_string(), "-1.25");
+
+    FixedPoint num3("-1.5", 64);
+    num3 += FixedPoint("2.75");
+    EXPECT_EQ(num3.to_string(), "1.25");
+
+    num3 *= num2;
+    num3 /= FixedPoint("0.5");
+    EXPECT_EQ(num3.to_string(), "-3.125");
+
+    FixedPoint moved = std::move(num3);
+    EXPECT_EQ(moved.to_string(), "-3.125");
+
+    FixedPoint sum = FixedPoint("989990361817605419587374691388.6317066907439150") - FixedPoint("10.08377835337406", 200);
+    EXPECT_EQ(sum.to_string(), "989990361817605419587374691378.54792833727451065677642822265625000000000000000000000000");
+}
+
+// Тест для хранения коротких чисел внутри объекта и перехода в кучу
+TEST_F(FixedPointTest, SmallBuffer) {
+    const size_t n = LimbVector::INLINE_LIMBS;
+    LimbVector small(n - 1, 7);
+    EXPECT_TRUE(small.is_inline());
+    small.insert(small.begin(), 1, 5);
+    EXPECT_TRUE(small.is_inline());
+    small.push_back(9);
+    EXPECT_FALSE(small.is_inline());
+    std::vector<uint32_t> expected(n + 1, 7);
+    expected.front() = 5;
+    expected.back() = 9;
+    EXPECT_EQ(std::vector<uint32_t>(small.begin(), small.end()), expected);
+
+    small.erase(small.begin(), small.begin() + 2);
+    expected.erase(expected.begin(), expected.begin() + 2);
+    LimbVector copy = small;
+    LimbVector moved = std::move(small);
+    EXPECT_EQ(std::vector<uint32_t>(moved.begin(), moved.end()), expected);
+    EXPECT_EQ(std::vector<uint32_t>(copy.begin(), copy.end()), expected);
+    EXPECT_TRUE(copy.is_inline());
+    EXPECT_TRUE(small.empty());
+
+    // Values growing across the inline capacity and shrinking back
+    FixedPoint num(3);
+    for (int i = 0; i < 6; i++) {
+        num = num * num;
+    }
+    EXPECT_EQ(num.to_string(), "3433683820292512484657849089281.0");
+    FixedPoint copied = num;
+    for (int i = 0; i < 5; i++) {
+        copied /= 243u;
+    }
+    EXPECT_EQ(copied.to_string(), "4052555153018976267.0");
+    copied = FixedPoint(-0.375, 3);
+    EXPECT_EQ(copied.to_string(), "-0.375");
+}
+
+// Тест для пула буферов: повторное использование, освобождение из других потоков, сброс
+TEST_F(FixedPointTest, LimbPool) {
+    LimbPool arena;
+    FixedPoint outside = FixedPoint("123456789012345678901234567890.5", 256);
+    {
+        ScopedLimbAllocator scope(&arena);
+        FixedPoint a = outside * outside;
+        size_t reserved = arena.reserved();
+        EXPECT_GT(reserved, 0u);
+
+        // Freed buffers serve the next temporaries of the same sizes
+        for (int i = 0; i < 1000; i++) {
+            a = (a * outside) / outside;
+        }
+        EXPECT_EQ(arena.reserved(), reserved);
+        EXPECT_EQ(a, outside * outside);
+
+        // Forked tasks allocate from the arena of the forking thread
+        TaskPool pool(3);
+        std::vector<FixedPoint> parts(8, FixedPoint(0, 0));
+        pool.run([&] {
+            std::function<void(size_t, size_t)> fill = [&](size_t lo, size_t hi) {
+                if (hi - lo == 1) {
+                    parts[lo] = outside * FixedPoint(lo + 1);
+                    return;
+                }
+                size_t mid = (lo + hi) / 2;
+                pool.fork_join([&] { fill(lo, mid); }, [&] { fill(mid, hi); });
+            };
+            fill(0, parts.size());
+        });
+        FixedPoint sum(0, 0);
+        for (const FixedPoint &part : parts) sum += part;
+        EXPECT_EQ(sum, outside * FixedPoint(36));
+        parts.clear();
+    }
+
+    // Values made outside the scope do not live in the arena
+    FixedPoint later = outside * outside;
+    arena.reset();
+    EXPECT_EQ(arena.reserved(), 0u);
+    EXPECT_EQ(later.to_string(), (outside * outside).to_string());
+}
+
+// Тест для ядер сложения и вычитания (скалярных и векторных)
+TEST_F(FixedPointTest, AdditionKernels) {
+    std::mt19937 rng(7);
+    limbs::AddThresholds saved = limbs::add_thresholds();
+
+    for (size_t n : {1, 7, 8, 15, 16, 33, 100, 257}) {
+        for (int pattern = 0; pattern < 3; pattern++) {
+            // Random limbs, then long runs of all-ones / zeros that carry through every lane
+            std::vector<limbs::limb_t> a(n), b(n);
+            for (auto &limb : a) limb = pattern == 0 ? rng() : (rng() % 4 ? 0xFFFFFFFFu : rng());
+            for (auto &limb : b) limb = pattern == 0 ? rng() : (pattern == 1 ? rng() % 2 : 0);
+            limbs::limb_t carry_in = rng() % 2;
+
+            limbs::add_thresholds().simd = 1000000;
+            std::vector<limbs::limb_t> scalar_sum(n), scalar_diff(n);
+            limbs::limb_t scalar_carry = limbs::add_n(scalar_sum.data(), a.data(), b.data(), n, carry_in);
+            limbs::limb_t scalar_borrow = limbs::sub_n(scalar_diff.data(), a.data(), b.data(), n, carry_in);
+
+            limbs::add_thresholds().simd = 1;
+            std::vector<limbs::limb_t> sum(n), diff(n);
+            EXPECT_EQ(limbs::add_n(sum.data(), a.data(), b.data(), n, carry_in), scalar_carry) << n;
+            EXPECT_EQ(limbs::sub_n(diff.data(), a.data(), b.data(), n, carry_in), scalar_borrow) << n;
+            EXPECT_EQ(sum, scalar_sum) << n;
+            EXPECT_EQ(diff, scalar_diff) << n;
+
+            // (a + b) - b gives a back with the same carry/borrow
+            std::vector<limbs::limb_t> back(n);
+            EXPECT_EQ(limbs::sub_n(back.data(), sum.data(), b.data(), n, carry_in), scalar_carry) << n;
+            EXPECT_EQ(back, a) << n;
+        }
+    }
+
+    limbs::add_thresholds() = saved;
+
+    // Carry through a long run of all-ones limbs on the FixedPoint level
+    FixedPoint max_int = FixedPoint("340282366920938463463374607431768211455") * FixedPoint("340282366920938463463374607431768211456");
+    max_int += FixedPoint("340282366920938463463374607431768211455");
+    EXPECT_EQ((max_int + FixedPoint("1")).to_string(), "115792089237316195423570985008687907853269984665640564039457584007913129639936.0");
+    EXPECT_EQ((max_int + FixedPoint("1") - FixedPoint("1")).to_string(), "115792089237316195423570985008687907853269984665640564039457584007913129639935.0");
+}
+
 // Тест для умножения
 TEST_F(FixedPointTest, Multiplication) {
     FixedPoint num1("10.5");
@@ -41,6 +225,117 @@ TEST_F(FixedPointTest, Multiplication) {
     EXPECT_EQ(result.to_string(), "21.0");
 }
 
+// Тест для умножения с переносами между словами и разными знаками
+TEST_F(FixedPointTest, MultiplicationCarries) {
+    FixedPoint num1("4294967295.75");
+    FixedPoint num2("-4294967295.5");
+    FixedPoint result = num1 * num2;
+    EXPECT_EQ(result.to_string(), "-18446744070488326144.125");
+}
+
+// Тест для Карацубы, Тоома-3 и несбалансированных операндов против умножения в столбик
+TEST_F(FixedPointTest, MultiplicationTiers) {
+    std::mt19937 rng(42);
+    limbs::MulThresholds saved = limbs::mul_thresholds();
+    limbs::mul_thresholds().karatsuba = 8;
+    limbs::mul_thresholds().toom3 = 24;
+
+    const std::vector<std::pair<size_t, size_t>> sizes = {{7, 7}, {16, 16}, {31, 20}, {64, 64}, {100, 57}, {300, 9}, {250, 90}};
+    for (auto [an, bn] : sizes) {
+        std::vector<limbs::limb_t> a(an), b(bn);
+        for (auto &limb : a) limb = rng();
+        for (auto &limb : b) limb = rng();
+
+        std::vector<limbs::limb_t> expected(an + bn), actual(an + bn);
+        limbs::mul_basecase(expected.data(), a.data(), an, b.data(), bn);
+        limbs::mul(actual.data(), a.data(), an, b.data(), bn);
+        EXPECT_EQ(actual, expected) << an << "x" << bn;
+    }
+
+    limbs::mul_thresholds() = saved;
+}
+
+// Тест для ядер школьного умножения: все поддерживаемые ядра дают одно и то же произведение
+TEST_F(FixedPointTest, MultiplicationKernels) {
+    std::mt19937 rng(23);
+    limbs::MulKernel saved = limbs::mul_kernel();
+    EXPECT_TRUE(limbs::mul_kernel_supported(limbs::MulKernel::portable));
+    EXPECT_TRUE(limbs::mul_kernel_supported(saved));
+
+    for (int i = 0; i < 300; i++) {
+        size_t an = 1 + rng() % 80, bn = 1 + rng() % 80;
+        std::vector<limbs::limb_t> a(an), b(bn);
+        for (auto &limb : a) limb = rng() % 4 ? rng() : (rng() % 2 ? 0 : 0xFFFFFFFF);
+        for (auto &limb : b) limb = rng() % 4 ? rng() : (rng() % 2 ? 0 : 0xFFFFFFFF);
+
+        std::vector<limbs::limb_t> expected(an + bn);
+        limbs::set_mul_kernel(limbs::MulKernel::portable);
+        limbs::mul_basecase(expected.data(), a.data(), an, b.data(), bn);
+        for (auto kernel : {limbs::MulKernel::wide, limbs::MulKernel::mulx_adx, limbs::MulKernel::ifma}) {
+            if (!limbs::mul_kernel_supported(kernel)) continue;
+            std::vector<limbs::limb_t> actual(an + bn, 7);
+            limbs::set_mul_kernel(kernel);
+            limbs::mul_basecase(actual.data(), a.data(), an, b.data(), bn);
+            EXPECT_EQ(actual, expected) << limbs::mul_kernel_name(kernel) << " " << an << "x" << bn;
+        }
+    }
+    limbs::set_mul_kernel(saved);
+    EXPECT_EQ(limbs::mul_kernel(), saved);
+}
+
+// Тест для умножения через теоретико-числовое преобразование
+TEST_F(FixedPointTest, MultiplicationNtt) {
+    std::mt19937 rng(7);
+
+    const std::vector<std::pair<size_t, size_t>> sizes = {{1, 1}, {3, 5}, {257, 256}, {1000, 3}, {777, 1201}};
+    for (auto [an, bn] : sizes) {
+        std::vector<limbs::limb_t> a(an), b(bn);
+        for (auto &limb : a) limb = rng();
+        for (auto &limb : b) limb = rng();
+        a.back() = b.back() = 0xFFFFFFFF;
+
+        std::vector<limbs::limb_t> expected(an + bn), actual(an + bn);
+        limbs::mul_basecase(expected.data(), a.data(), an, b.data(), bn);
+        limbs::mul_ntt(actual.data(), a.data(), an, b.data(), bn);
+        EXPECT_EQ(actual, expected) << an << "x" << bn;
+    }
+}
+
+// Тест для возведения в квадрат: все уровни и ядра против умножения в столбик
+TEST_F(FixedPointTest, Squaring) {
+    std::mt19937 rng(11);
+    limbs::MulThresholds saved = limbs::mul_thresholds();
+    limbs::MulKernel saved_kernel = limbs::mul_kernel();
+    limbs::mul_thresholds().sqr_karatsuba = 8;
+    limbs::mul_thresholds().toom3 = 24;
+    limbs::mul_thresholds().ntt = 200;
+
+    for (size_t n : {1, 5, 16, 31, 64, 150, 301}) {
+        std::vector<limbs::limb_t> a(n);
+        for (auto &limb : a) limb = rng() % 4 ? rng() : 0xFFFFFFFF;
+        std::vector<limbs::limb_t> copy = a, expected(2 * n), actual(2 * n);
+        limbs::mul_basecase(expected.data(), a.data(), n, copy.data(), n);
+        limbs::sqr(actual.data(), a.data(), n);
+        EXPECT_EQ(actual, expected) << n;
+
+        for (auto kernel : {limbs::MulKernel::portable, limbs::MulKernel::wide, limbs::MulKernel::mulx_adx,
+                            limbs::MulKernel::ifma}) {
+            if (!limbs::mul_kernel_supported(kernel)) continue;
+            std::vector<limbs::limb_t> basecase(2 * n, 7);
+            limbs::set_mul_kernel(kernel);
+            limbs::sqr_basecase(basecase.data(), a.data(), n);
+            EXPECT_EQ(basecase, expected) << limbs::mul_kernel_name(kernel) << " " << n;
+        }
+        limbs::set_mul_kernel(saved_kernel);
+    }
+
+    limbs::mul_thresholds() = saved;
+
+    // x * x с одним и тем же операндом идёт через возведение в квадрат
+    FixedPoint num("-4294967295.75");
+    EXPECT_EQ((num * num).to_string(), "18446744071562067968.0625");
+}
+
 // Тест для деления
 TEST_F(FixedPointTest, Division) {
     FixedPoint num1("21.0", 2);
@@ -49,6 +344,287 @@ TEST_F(FixedPointTest, Division) {
     EXPECT_EQ(result.to_string(), "10.5");
 }
 
+// Тест для деления по словам с выравниванием дробной части делителя
+TEST_F(FixedPointTest, DivisionKnuth) {
+    FixedPoint num1("-1000000000000000000000.5", 64);
+    FixedPoint num2("3.25", 32);
+    FixedPoint result = num1 / num2;
+    EXPECT_EQ(result.to_string(), "-307692307692307692307.846153846153846153846153");
+
+    FixedPoint zero("0.0");
+    EXPECT_THROW(num1 / zero, std::runtime_error);
+}
+
+// Тест для деления через обратную величину Ньютона против побитового деления
+TEST_F(FixedPointTest, DivisionNewton) {
+    FixedPoint num1("-123456789012345678901234567890123456789.123456789", 320);
+    FixedPoint num2("98765432109876543210.98765432109876543210987654321", 192);
+    num1 = num1 * num1;
+
+    size_t saved = limbs::div_thresholds().newton;
+    limbs::div_thresholds().newton = 1000000;
+    FixedPoint expected = num1 / num2;
+    limbs::div_thresholds().newton = 1;
+    FixedPoint actual = num1 / num2;
+    limbs::div_thresholds().newton = saved;
+
+    EXPECT_TRUE(actual == expected);
+    EXPECT_EQ(actual.to_string(), expected.to_string());
+
+    // Одна и та же обратная величина для нескольких делимых
+    FixedPoint::Reciprocal inv(num2);
+    EXPECT_EQ((num1 / inv).to_string(), expected.to_string());
+    EXPECT_EQ((num2 / inv).to_string(), "1.0");
+}
+
+// Тест для квадратного корня и обратного квадратного корня
+TEST_F(FixedPointTest, SquareRoot) {
+    EXPECT_EQ(sqrt(FixedPoint(144, 0), 64).to_string(), "12.0");
+    EXPECT_EQ(sqrt(FixedPoint("0.0625", 32), 32).to_string(), "0.25");
+    EXPECT_EQ(rsqrt(FixedPoint(4, 0), 32).to_string(), "0.5");
+    EXPECT_EQ(sqrt(FixedPoint(0, 0), 32).to_string(), "0.0");
+
+    EXPECT_EQ(sqrt(FixedPoint(2, 0), 400).to_string().substr(0, 102),
+              "1.4142135623730950488016887242096980785696718753769480731766797379907324784621070388503875343276415727");
+    EXPECT_EQ(rsqrt(FixedPoint(2, 0), 400).to_string().substr(0, 102),
+              "0.7071067811865475244008443621048490392848359376884740365883398689953662392310535194251937671638207863");
+
+    // Результат усечён: c * c <= x < (c + 2^-p)^2, в том числе для очень больших и очень малых x
+    std::mt19937 rng(17);
+    const FixedPoint one(1, 0);
+    for (int i = 0; i < 40; i++) {
+        FixedPoint x(static_cast<int64_t>(rng()) + 1, 0);
+        for (int j = rng() % 6; j > 0; j--) x = x * FixedPoint(static_cast<int64_t>(rng()), 0);
+        x.set_precision(1024);
+        x = x / FixedPoint(static_cast<int64_t>(1) << (rng() % 63), 0);
+        if (i % 2) x = x * x;
+
+        size_t p = 1 + rng() % 900;
+        FixedPoint ulp(std::ldexp(1.0, -static_cast<int>(p)), static_cast<int>(p));
+        FixedPoint s = sqrt(x, p), s_next = s + ulp;
+        FixedPoint r = rsqrt(x, p), r_next = r + ulp;
+        EXPECT_TRUE(s * s <= x && s_next * s_next > x) << x.to_string(40) << " " << p;
+        EXPECT_TRUE(x * (r * r) <= one && x * (r_next * r_next) > one) << x.to_string(40) << " " << p;
+    }
+
+    EXPECT_THROW(sqrt(FixedPoint(-1, 0), 32), std::runtime_error);
+    EXPECT_THROW(rsqrt(FixedPoint(0, 0), 32), std::runtime_error);
+}
+
+// Тест для умножения и деления на машинное слово
+TEST_F(FixedPointTest, WordOperations) {
+    FixedPoint num("-100.5");
+    EXPECT_EQ((num / 3u).to_string(), "-33.5");
+    EXPECT_EQ((num / 3u * 7u).to_string(), "-234.5");
+    EXPECT_EQ(num % 7u, 2u);
+    EXPECT_EQ((FixedPoint("4294967295.75") * 4u).to_string(), "17179869183.0");
+    EXPECT_EQ((FixedPoint("1.0", 64) / 3u).to_string(), "0.3333333333333333");
+    EXPECT_THROW(num / 0u, std::runtime_error);
+
+    // Doubles and signed or wide integers are not words: they convert to FixedPoint
+    FixedPoint x("2.5");
+    EXPECT_EQ((x * 2.5).to_string(), (x * FixedPoint(2.5)).to_string());
+    EXPECT_EQ((x * -2).to_string(), (x * FixedPoint(-2)).to_string());
+    EXPECT_EQ((x / 0.5).to_string(), (x / FixedPoint(0.5)).to_string());
+    EXPECT_EQ((x * 2.5).to_string(), "6.25");
+    EXPECT_EQ((x * -2).to_string(), "-5.0");
+    EXPECT_EQ((x / 0.5).to_string(), "5.0");
+    EXPECT_EQ((x * (uint64_t(1) << 40)).to_string(), (x << 40).to_string());
+    FixedPoint y = x;
+    y *= -2;
+    y /= 0.5;
+    EXPECT_EQ(y.to_string(), "-10.0");
+    EXPECT_EQ(FixedPoint(lazy(x) * 2.5).to_string(), "6.25");
+    EXPECT_EQ(FixedPoint(lazy(x) / -2).to_string(), (x / FixedPoint(-2)).to_string());
+}
+
+// Тест для сдвигов и умножения на степени двойки
+TEST_F(FixedPointTest, Shifts) {
+    FixedPoint num("-100.5");
+    EXPECT_EQ((num << 4).to_string(), "-1608.0");
+    EXPECT_EQ((num >> 3).to_string(), (num / 8u).to_string());
+    EXPECT_EQ((FixedPoint("1.5") >> 33).to_string(), "0.0");
+    EXPECT_EQ((FixedPoint("0.75") << 65).to_string(), "27670116110564327424.0");
+
+    // ldexp moves the radix point instead of truncating
+    FixedPoint tiny = ldexp(FixedPoint(3, 0), -40);
+    EXPECT_EQ(ldexp(tiny, 40).to_string(), "3.0");
+    EXPECT_EQ((tiny << 40).to_string(), "3.0");
+    EXPECT_EQ(ldexp(num, 70).to_string(), (num << 70).to_string());
+
+    std::mt19937 rng(25);
+    for (int i = 0; i < 200; i++) {
+        FixedPoint a((rng() % 2 ? "-" : "") + std::to_string(rng()) + "." + std::to_string(rng()), 96);
+        size_t k = rng() % 31;
+        uint32_t p = 1u << k;
+        EXPECT_EQ((a << k).to_string(), (a * p).to_string()) << i;
+        EXPECT_EQ((a >> k).to_string(), (a / p).to_string()) << i;
+        EXPECT_EQ(ldexp(ldexp(a, -static_cast<ptrdiff_t>(k) - 64), k + 64), a) << i;
+
+        FixedPoint b = a;
+        b <<= k + 40;
+        b >>= k + 40;
+        EXPECT_EQ(b.to_string(), ((a << (k + 40)) >> (k + 40)).to_string()) << i;
+    }
+}
+
+// Тест для ленивых выражений: тот же результат, что у обычных операторов
+TEST_F(FixedPointTest, LazyExpressions) {
+    std::mt19937 rng(21);
+    auto random_number = [&](int frac_bits) {
+        std::string digits = (rng() % 2 ? "-" : "") + std::to_string(rng()) + std::to_string(rng() % 1000) + "." + std::to_string(rng());
+        return FixedPoint(digits, frac_bits);
+    };
+
+    for (int i = 0; i < 200; i++) {
+        FixedPoint a = random_number(32 * (rng() % 5)), b = random_number(1 + rng() % 200);
+        FixedPoint c = random_number(64), d = random_number(32 * (rng() % 3));
+        uint32_t k = rng() | 1, m = rng() % 1000 + 1;
+
+        FixedPoint eager = a / k - b * m + c - d / m * k;
+        FixedPoint fused = lazy(a) / k - lazy(b) * m + c - lazy(d) / m * k;
+        EXPECT_EQ(fused.to_string(), eager.to_string()) << i;
+
+        // Unfusable steps are evaluated on the way
+        EXPECT_EQ(FixedPoint((lazy(a) + b) / k).to_string(), ((a + b) / k).to_string()) << i;
+        EXPECT_EQ(FixedPoint((lazy(c) - d) * k * k).to_string(), ((c - d) * k * k).to_string()) << i;
+        EXPECT_EQ(((lazy(a) - c) * b).to_string(), ((a - c) * b).to_string()) << i;
+
+        FixedPoint acc = a;
+        acc -= lazy(b) * 3u + d / 7u;
+        EXPECT_EQ(acc.to_string(), (a - (b * 3u + d / 7u)).to_string()) << i;
+    }
+    EXPECT_THROW(FixedPoint(lazy(FixedPoint(1)) / 0u), std::runtime_error);
+}
+
+// Тест для чисел фиксированной ширины: constexpr, дополнительный код, обмен с FixedPoint
+TEST_F(FixedPointTest, StaticFixedPoint) {
+    using Fixed = StaticFixedPoint<2, 3>;
+    static_assert(Fixed(3) + Fixed(-5) == Fixed(-2), "constexpr addition");
+    static_assert(Fixed(-6) * Fixed(7) == Fixed(-42), "constexpr product");
+    static_assert(Fixed(7) / 2u * 2u == Fixed(7), "halves are exact");
+    static_assert(Fixed(-1) < Fixed(0) && Fixed(5) >= Fixed(5), "constexpr comparison");
+
+    std::mt19937 rng(22);
+    for (int i = 0; i < 200; i++) {
+        std::string digits = (rng() % 2 ? "-" : "") + std::to_string(rng() % 1000000) + "." + std::to_string(rng());
+        FixedPoint a(digits, 96), b(std::to_string(rng() % 1000) + "." + std::to_string(rng()), 96);
+        uint32_t k = rng() | 1;
+
+        EXPECT_EQ(FixedPoint(Fixed(a)).to_string(), a.to_string()) << i;
+        EXPECT_EQ((Fixed(a) + Fixed(b)).to_string(), (a + b).to_string()) << i;
+        EXPECT_EQ((Fixed(a) - Fixed(b)).to_string(), (a - b).to_string()) << i;
+        EXPECT_EQ((Fixed(a) / k).to_string(), (a / k).to_string()) << i;
+        EXPECT_EQ((Fixed(a) * k).to_string(), (a * k).to_string()) << i;
+        EXPECT_EQ((Fixed(a) << (k % 32)).to_string(), (a << (k % 32)).to_string()) << i;
+        EXPECT_EQ((Fixed(a) >> (k % 96)).to_string(), (a >> (k % 96)).to_string()) << i;
+        EXPECT_EQ(Fixed(a) < Fixed(b), a < b) << i;
+
+        // The product is truncated to 96 fractional bits
+        EXPECT_TRUE(Fixed(a) * Fixed(b) == Fixed(a * b)) << i;
+    }
+
+    // Integer parts wrap around, conversions from too large numbers throw
+    EXPECT_EQ((StaticFixedPoint<1, 1>(0x7FFFFFFF) + StaticFixedPoint<1, 1>(1)).to_string(), "-2147483648.0");
+    EXPECT_THROW(Fixed(FixedPoint("18446744073709551616", 0)), std::overflow_error);
+    EXPECT_THROW(Fixed(1) / 0u, std::runtime_error);
+
+    FixedPoint pi(0, 0);
+    CalcPi(pi, 0, 120, FixedPoint(1, 512));
+    EXPECT_EQ(pi.to_string().substr(0, 102), pi_right);
+}
+
+// Тест для перевода в десятичную строку (разбиение по степеням 10^9)
+TEST_F(FixedPointTest, DecimalOutput) {
+    std::mt19937 rng(9);
+    limbs::RadixThresholds saved = limbs::radix_thresholds();
+    size_t saved_newton = limbs::div_thresholds().newton;
+
+    for (size_t n : {1, 3, 40, 300}) {
+        std::vector<limbs::limb_t> a(n);
+        for (auto &limb : a) limb = rng() % 4 ? rng() : 0;
+
+        limbs::radix_thresholds().divide_conquer = 1000000;
+        std::string expected = limbs::to_decimal(a.data(), n, 3000);
+
+        limbs::radix_thresholds().divide_conquer = 2;
+        limbs::div_thresholds().newton = 8;
+        EXPECT_EQ(limbs::to_decimal(a.data(), n, 3000), expected) << n;
+        limbs::div_thresholds().newton = saved_newton;
+        EXPECT_EQ(limbs::to_decimal(a.data(), n, 3000), expected) << n;
+    }
+
+    limbs::radix_thresholds() = saved;
+
+    std::vector<limbs::limb_t> zero(3, 0), chunk = {1000000000};
+    EXPECT_EQ(limbs::to_decimal(zero.data(), zero.size()), "0");
+    EXPECT_EQ(limbs::to_decimal(zero.data(), zero.size(), 4), "0000");
+    EXPECT_EQ(limbs::to_decimal(chunk.data(), chunk.size()), "1000000000");
+    EXPECT_EQ(limbs::to_decimal(limbs::pow_1(10, 400).data(), 42), "1" + std::string(400, '0'));
+
+    // Exact binary fractions keep all their digits, inexact ones print 8 digits per limb
+    FixedPoint tiny = FixedPoint("1") / FixedPoint("4294967296");
+    EXPECT_EQ(tiny.to_string(), "0.00000000");
+    EXPECT_EQ(FixedPoint("0.5", 128).to_string(), "0.5");
+    EXPECT_EQ(FixedPoint("-12345678901234567890123.0").to_string(), "-12345678901234567890123.0");
+}
+
+// Тест для потокового вывода цифр частями
+TEST_F(FixedPointTest, StreamingOutput) {
+    limbs::RadixThresholds saved = limbs::radix_thresholds();
+    limbs::radix_thresholds().divide_conquer = 2;
+
+    FixedPoint num("-123456789012345678901234567890.0625", 256);
+    std::ostringstream out;
+    num.write(out, 20, 7);
+    EXPECT_EQ(out.str(), "-123456789012345678901234567890.06250000000000000000");
+
+    // Same digits as to_string, whatever the chunk size
+    FixedPoint third = FixedPoint(1, 2048) / FixedPoint(3);
+    std::string expected = third.to_string();
+    for (size_t chunk : {1, 13, 1 << 16}) {
+        std::ostringstream stream;
+        third.write(stream, expected.size() - 2, chunk);
+        EXPECT_EQ(stream.str(), expected) << chunk;
+    }
+
+    std::ostringstream zero;
+    FixedPoint(0, 0).write(zero, 3);
+    EXPECT_EQ(zero.str(), "0.000");
+
+    limbs::radix_thresholds() = saved;
+}
+
+// Тест для разбора десятичной строки (накопление по 10^9 и разбиение по степеням)
+TEST_F(FixedPointTest, DecimalParsing) {
+    std::mt19937 rng(11);
+    limbs::RadixThresholds saved = limbs::radix_thresholds();
+
+    for (size_t len : {1, 9, 10, 100, 1000, 5000}) {
+        std::string digits;
+        for (size_t i = 0; i < len; i++) digits.push_back('0' + rng() % 10);
+
+        limbs::radix_thresholds().divide_conquer = 1000000;
+        std::vector<limbs::limb_t> expected = limbs::from_decimal(digits.data(), len);
+        limbs::radix_thresholds().divide_conquer = 2;
+        std::vector<limbs::limb_t> actual = limbs::from_decimal(digits.data(), len);
+        EXPECT_EQ(actual, expected) << len;
+
+        limbs::radix_thresholds() = saved;
+        EXPECT_EQ(limbs::to_decimal(actual.data(), actual.size(), len), digits) << len;
+    }
+
+    EXPECT_TRUE(limbs::from_decimal("000", 3).empty());
+
+    // A long number parses and prints back unchanged
+    std::string int_digits(3000, '7'), frac_digits = "5";
+    for (int i = 0; i < 99; i++) frac_digits += "0625";
+    FixedPoint num(int_digits + ".0625", 4000);
+    EXPECT_EQ(num.to_string(), int_digits + ".0625");
+    EXPECT_EQ(FixedPoint("0." + frac_digits, 64).to_string(), "0.5062506250625062");
+    EXPECT_EQ(FixedPoint("-0.1", 7).to_string(), "-0.09375");
+}
+
 // Тест для сравнения
 TEST_F(FixedPointTest, Comparison) {
     FixedPoint num1("10.5");
@@ -56,12 +632,19 @@ TEST_F(FixedPointTest, Comparison) {
     EXPECT_TRUE(num1 < num2);
     EXPECT_FALSE(num1 > num2);
     EXPECT_TRUE(num1 != num2);
+
+    // Magnitudes are compared at the radix point, a zero fraction limb changes nothing
+    FixedPoint whole(1, 0), padded(1, 32);
+    EXPECT_TRUE(whole == padded);
+    EXPECT_FALSE(padded > whole);
+    EXPECT_FALSE(whole < padded);
+    EXPECT_TRUE(FixedPoint("1.5", 64) > FixedPoint(1, 0));
 }
 
 // Тест для числа Pi
 TEST_F(FixedPointTest, PiCalculation) {
     auto start = std::chrono::high_resolution_clock::now();
-    FixedPoint pi = get_pi();
+    FixedPoint pi = get_pi(100);
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>
                    (std::chrono::high_resolution_clock::now() - start);
     std::string pi_str = pi.to_string();
@@ -70,4 +653,178 @@ TEST_F(FixedPointTest, PiCalculation) {
     EXPECT_EQ(pi_str, pi_right);
     EXPECT_TRUE(duration.count() < 1000);
 
+}
+
+// Тест для числа пи с большим количеством знаков (ряд Чудновского)
+TEST_F(FixedPointTest, PiChudnovsky) {
+    std::string pi_str = get_pi(1000).to_string();
+    ASSERT_GE(pi_str.size(), 1002u);
+    EXPECT_EQ(pi_str.substr(0, 102), pi_right);
+    EXPECT_EQ(pi_str.substr(962, 40), "1712268066130019278766111959092164201989");
+
+    // More digits only extend the expansion
+    EXPECT_EQ(get_pi(3000).to_string().substr(0, 1002), pi_str.substr(0, 1002));
+}
+
+// Тест для извлечения шестнадцатеричных цифр пи по формуле BBP
+TEST_F(FixedPointTest, PiHexDigits) {
+    EXPECT_EQ(pi_hex_digits(0, 24), "243F6A8885A308D313198A2E");
+    EXPECT_EQ(pi_hex_digits(5000, 30, 3), "CAD181156B2395E0333E92E13B240B");
+    EXPECT_EQ(pi_hex_digits(19990, 10, 2), "EBF50C76DA");
+}
+
+// Тест для пула потоков с перехватом задач
+TEST_F(FixedPointTest, TaskPool) {
+    TaskPool pool(4);
+    std::function<uint64_t(uint64_t, uint64_t)> sum = [&](uint64_t a, uint64_t b) -> uint64_t {
+        if (b - a <= 8) {
+            uint64_t s = 0;
+            for (uint64_t i = a; i < b; i++) s += i * i;
+            return s;
+        }
+        uint64_t left = 0, right = 0, m = (a + b) / 2;
+        pool.fork_join([&] { left = sum(a, m); }, [&] { right = sum(m, b); });
+        return left + right;
+    };
+
+    uint64_t total = 0;
+    pool.run([&] { total = sum(0, 100000); });
+    EXPECT_EQ(total, 333328333350000ull);
+
+    // Without run() the halves simply run on the calling thread
+    EXPECT_EQ(sum(0, 1000), 332833500ull);
+
+    EXPECT_THROW(pool.run([&] { pool.fork_join([] {}, [] { throw std::runtime_error("right"); }); }), std::runtime_error);
+}
+
+// Тест для двоичного формата: версия, порядок байт, чтение на месте и через mmap
+TEST_F(FixedPointTest, Serialization) {
+    FixedPoint num("-98765432109876543210.125", 100);
+    std::stringstream stream;
+    num.write_binary(stream);
+    std::string image = stream.str();
+    ASSERT_EQ(image.size() % 8, 0u);
+    EXPECT_EQ(image.substr(0, 4), "FXPT");
+    EXPECT_EQ(image[4], 1);
+    EXPECT_EQ(image[7], 1);
+
+    std::vector<uint64_t> buffer(image.size() / 8);
+    std::memcpy(buffer.data(), image.data(), image.size());
+    FixedPointView view(buffer.data(), image.size());
+    EXPECT_TRUE(view.is_negative());
+    EXPECT_EQ(view.image_size(), image.size());
+    EXPECT_EQ(view.fractional(), reinterpret_cast<const uint32_t *>(buffer.data()) + 8);
+    EXPECT_EQ(view.integer_size(), 3u);
+    EXPECT_EQ(view.to_fixed_point().to_string(), num.to_string());
+    EXPECT_THROW(FixedPointView(buffer.data(), image.size() - 8), std::runtime_error);
+    EXPECT_THROW(FixedPointView(reinterpret_cast<const char *>(buffer.data()) + 1, image.size() - 1), std::runtime_error);
+
+    std::string other_version = image;
+    other_version[4] = 2;
+    std::stringstream old(other_version);
+    EXPECT_THROW(FixedPoint::read_binary(old), std::runtime_error);
+
+    // A corrupt limb count runs into the end of the stream instead of being allocated
+    std::string huge = image.substr(0, 32);
+    huge.replace(16, 8, std::string("\0\0\0\0\0\1\0\0", 8));
+    std::stringstream huge_stream(huge + image.substr(32));
+    EXPECT_THROW(FixedPoint::read_binary(huge_stream), std::runtime_error);
+
+    // fractional_bits has to end in the last of the 4 fractional limbs
+    for (uint32_t frac_bits : {0u, 96u, 129u}) {
+        std::string malformed = image;
+        malformed.replace(8, 4, std::string(reinterpret_cast<const char *>(&frac_bits), 4));
+        std::stringstream malformed_stream(malformed);
+        EXPECT_THROW(FixedPoint::read_binary(malformed_stream), std::runtime_error) << frac_bits;
+    }
+
+    // Zero integer limbs above the top one are trimmed like after any operation: the
+    // padding limb of an image of 5 counted as a second integer limb
+    std::stringstream five;
+    FixedPoint(5, 0).write_binary(five);
+    std::string padded = five.str();
+    padded[24] = 2;
+    std::stringstream padded_stream(padded);
+    FixedPoint trimmed = FixedPoint::read_binary(padded_stream);
+    std::stringstream rewritten;
+    trimmed.write_binary(rewritten);
+    EXPECT_EQ(rewritten.str(), five.str());
+
+    std::string path = testing::TempDir() + "fixed_point_image.bin";
+    FixedPoint pi = get_pi(2000);
+    {
+        std::ofstream file(path, std::ios::binary);
+        pi.write_binary(file);
+    }
+    {
+        MappedFixedPoint mapped(path);
+        EXPECT_FALSE(mapped.view().is_negative());
+        EXPECT_EQ(mapped.view().to_fixed_point().to_string(), pi.to_string());
+    }
+    std::remove(path.c_str());
+    EXPECT_THROW(MappedFixedPoint("/nonexistent/fixed_point_image.bin"), std::runtime_error);
+}
+
+// Тест для контрольных точек: запись в фоне, продолжение вычисления пи
+TEST_F(FixedPointTest, Checkpoint) {
+    std::string path = testing::TempDir() + "pi_checkpoint_test.bin";
+
+    FixedPoint num("-98765432109876543210.125", 100);
+    std::stringstream image;
+    num.write_binary(image);
+    FixedPoint restored = FixedPoint::read_binary(image);
+    EXPECT_EQ(restored.to_string(), num.to_string());
+    EXPECT_THROW(FixedPoint::read_binary(image), std::runtime_error);
+
+    {
+        CheckpointWriter writer(path);
+        for (int i = 0; i < 5; i++) {
+            writer.submit([i](std::ostream &out) { out << "snapshot " << i; });
+        }
+        writer.flush();
+        std::ifstream in(path);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(content, "snapshot 4");
+    }
+
+    // A file that is not a checkpoint of this run is refused
+    EXPECT_THROW(get_pi(20000, 2, path, true), std::runtime_error);
+
+    // Ranges that do not continue the terms from 0 are refused
+    auto write_ranges = [&](uint64_t a, uint64_t b) {
+        std::ofstream out(path, std::ios::binary);
+        uint64_t fields[5] = {20000, 20000 / 14 + 2, 1, a, b};
+        unsigned char header[sizeof fields];
+        for (size_t i = 0; i < 5; i++) store_le(header + 8 * i, fields[i], 8);
+        out.write("PICKPT02", 8);
+        out.write(reinterpret_cast<const char *>(header), sizeof header);
+        for (int i = 0; i < 3; i++) FixedPoint(1, 0).write_binary(out);
+    };
+    write_ranges(5, 10);
+    EXPECT_THROW(get_pi(20000, 2, path, true), std::runtime_error);
+    write_ranges(0, 5000);
+    EXPECT_THROW(get_pi(20000, 2, path, true), std::runtime_error);
+    std::remove(path.c_str());
+
+    std::string expected = get_pi(40000).to_string();
+    EXPECT_EQ(get_pi(40000, 2, path).to_string(), expected);
+    EXPECT_FALSE(std::ifstream(path).good());
+
+    // 40000 digits take 12 blocks of 256 terms. A run stopped after 5 blocks leaves a
+    // stack of [0, 1024) and [1024, 1280), which the next runs continue
+    EXPECT_FALSE(advance_pi_checkpoint(40000, 2, path, 5));
+    EXPECT_EQ(get_pi(40000, 3, path, true).to_string(), expected);
+    EXPECT_FALSE(std::ifstream(path).good());
+
+    EXPECT_FALSE(advance_pi_checkpoint(40000, 1, path, 5));
+    EXPECT_TRUE(advance_pi_checkpoint(40000, 2, path, 7));
+    EXPECT_EQ(get_pi(40000, 2, path, true).to_string(), expected);
+    EXPECT_FALSE(std::ifstream(path).good());
+}
+
+// Тест для многопоточного вычисления пи: результат не зависит от числа потоков
+TEST_F(FixedPointTest, PiThreads) {
+    FixedPoint single = get_pi(70000, 1);
+    FixedPoint parallel = get_pi(70000, 4);
+    EXPECT_EQ(parallel.to_string(), single.to_string());
 }
\ No newline at end of file